@@ -0,0 +1,44 @@
+#include "EntityStore.h"
+
+#include <stdexcept>
+#include <emmintrin.h>
+
+EntityStore::EntityStore(size_t groupSize, size_t enemyCount) {
+    size = groupSize + enemyCount;
+    g_size = groupSize;
+    e_size = enemyCount;
+    if (g_size > maxSideEntities || e_size > maxSideEntities) {
+        throw std::logic_error("Number of entities of a side exceeds 64, need different mask type instead of uint64");
+    }
+    paddedSize = (size + 3) / 4 * 4;
+    stacks.resize(paddedSize, 0);
+    durations.resize(paddedSize, 0.0f);
+    //every entity starts with 0 stacks
+    stackBuckets[0][0] = g_size == 64 ? ~0ULL : (1ULL << g_size) - 1;
+    stackBuckets[1][0] = e_size == 64 ? ~0ULL : (1ULL << e_size) - 1;
+}
+
+// decrements the durations of all entities with a running debuff/buff, returns the mask of the entities whose debuff/buff ran out in this step
+// (inactive durations are decremented by 0, so every lane does the same float subtraction as advanceTime for Entities)
+EntityMask decrementDurations(EntityStore& entities, float timeDelta) {
+    float* durations = entities.durations.data();
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 delta = _mm_set1_ps(timeDelta);
+    EntityMask expired{ 0 };
+    for (size_t index = 0; index < entities.paddedSize; index += 4) {
+        __m128 duration = _mm_loadu_ps(durations + index);
+        __m128 active = _mm_cmpgt_ps(duration, zero);
+        duration = _mm_sub_ps(duration, _mm_and_ps(active, delta));
+        _mm_storeu_ps(durations + index, duration);
+        __m128 runOut = _mm_and_ps(active, _mm_cmple_ps(duration, zero));
+        //4 aligned lanes never cross a word
+        expired[index / 64] |= static_cast<uint64_t>(_mm_movemask_ps(runOut)) << (index % 64);
+    }
+    return expired;
+}
+
+// every entity that is not in the 0 stack bucket has stacks
+void recordSwarmStats(const EntityStore& entities, SwarmStats& stats) {
+    stats.friendlyTicks += (int)entities.g_size - countBits(entities.stackBuckets[0][0]);
+    stats.enemyTicks += (int)entities.e_size - countBits(entities.stackBuckets[1][0]);
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <climits>
+
+#include "WowSwarmSimulator.h"
+
+// structure of arrays version of Entities for the sweep:
+// stacks and durations of the whole group followed by all enemies are contiguous (same indices as Entities)
+// so the per step work of advanceTime (see SwarmQueue.h) is a branch free kernel over plain arrays.
+// the kernel works on 4 entities per SSE2 instruction and returns a bit mask over the entity indices.
+// the arrays are padded to a multiple of 4 with entities that never have stacks or a running duration.
+// the store also indexes the entities by stacks: per side and stack count a bit mask of the side indices (entity index - g_size for enemies),
+// so target selection (findEntity, getNthEntity, ...) and tick counting are a few bit operations instead of scans over all entities.
+// every stack change has to go through setStacks to keep the buckets up to date. a side holds at most 64 entities.
+
+constexpr size_t maxSideEntities = 64;
+// bit i % 64 of word i / 64 is entity i
+typedef std::array<uint64_t, 2> EntityMask;
+
+// reference to the fields of one entity of the store, so the strategy functions can use entities[index].stacks for both layouts
+struct EntityRef {
+    const int& stacks;
+    float& duration;
+    bool isEnemy;
+};
+
+struct EntityStore {
+    size_t size = 0;
+    size_t g_size = 0;
+    size_t e_size = 0;
+    size_t paddedSize = 0;
+    std::vector<int> stacks;
+    std::vector<float> durations;
+    // [side][stacks], side 0 is the group and side 1 the enemies
+    std::array<std::array<uint64_t, 6>, 2> stackBuckets{ 0 };
+
+    EntityStore(size_t groupSize, size_t enemyCount);
+
+    // no range check, same as the vectors
+    EntityRef operator[](size_t index) {
+        return { stacks[index], durations[index], index >= g_size };
+    }
+};
+
+// portable versions of the bit operations of <bit> (C++20)
+inline int countBits(uint64_t mask) {
+    mask = mask - ((mask >> 1) & 0x5555555555555555ULL);
+    mask = (mask & 0x3333333333333333ULL) + ((mask >> 2) & 0x3333333333333333ULL);
+    mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((mask * 0x0101010101010101ULL) >> 56);
+}
+
+inline int findLowestBit(uint64_t mask) {
+    return countBits((mask & (0 - mask)) - 1);
+}
+
+inline int findHighestBit(uint64_t mask) {
+    int position = 0;
+    for (int width = 32; width > 0; width /= 2) {
+        if (mask >> width) {
+            mask >>= width;
+            position += width;
+        }
+    }
+    return position;
+}
+
+// position of the n-th (0 based) set bit, mask has to have more than n set bits
+inline int selectBit(uint64_t mask, int n) {
+    int position = 0;
+    for (int width = 32; width > 0; width /= 2) {
+        uint64_t lowMask = (1ULL << width) - 1;
+        int lowCount = countBits(mask & lowMask);
+        if (n >= lowCount) {
+            n -= lowCount;
+            mask >>= width;
+            position += width;
+        }
+        else {
+            mask &= lowMask;
+        }
+    }
+    return position;
+}
+
+inline void setStacks(EntityStore& entities, int index, int stacks) {
+    int side = index >= (int)entities.g_size ? 1 : 0;
+    uint64_t bit = 1ULL << (side ? index - (int)entities.g_size : index);
+    entities.stackBuckets[side][entities.stacks[index]] &= ~bit;
+    entities.stackBuckets[side][stacks] |= bit;
+    entities.stacks[index] = stacks;
+}
+
+// lowest (ascending) or highest (descending) entity index with the given stacks on the side, -1 if there is none
+inline int findEntity(const EntityStore& entities, int stacks, EntitySide side, ScanOrder order) {
+    uint64_t group = side != EntitySide::ENEMY ? entities.stackBuckets[0][stacks] : 0;
+    uint64_t enemies = side != EntitySide::FRIENDLY ? entities.stackBuckets[1][stacks] : 0;
+    if (order == ScanOrder::ASCENDING) {
+        if (group) {
+            return findLowestBit(group);
+        }
+        return enemies ? (int)entities.g_size + findLowestBit(enemies) : -1;
+    }
+    if (enemies) {
+        return (int)entities.g_size + findHighestBit(enemies);
+    }
+    return group ? findHighestBit(group) : -1;
+}
+
+inline int countEntities(const EntityStore& entities, int stacks, EntitySide side) {
+    int count = 0;
+    if (side != EntitySide::ENEMY) {
+        count += countBits(entities.stackBuckets[0][stacks]);
+    }
+    if (side != EntitySide::FRIENDLY) {
+        count += countBits(entities.stackBuckets[1][stacks]);
+    }
+    return count;
+}
+
+// fewest stacks of any entity on the side
+inline int getLowestStacks(const EntityStore& entities, EntitySide side) {
+    for (int stacks = 0; stacks < 6; stacks++) {
+        if (countEntities(entities, stacks, side) > 0) {
+            return stacks;
+        }
+    }
+    return INT_MAX;
+}
+
+// n-th (0 based) entity with the given stacks on the side in ascending index order, -1 if there are not enough
+inline int getNthEntity(const EntityStore& entities, int stacks, EntitySide side, int n) {
+    uint64_t group = side != EntitySide::ENEMY ? entities.stackBuckets[0][stacks] : 0;
+    uint64_t enemies = side != EntitySide::FRIENDLY ? entities.stackBuckets[1][stacks] : 0;
+    int groupCount = countBits(group);
+    if (n < groupCount) {
+        return selectBit(group, n);
+    }
+    n -= groupCount;
+    return n < countBits(enemies) ? (int)entities.g_size + selectBit(enemies, n) : -1;
+}
+
+EntityMask decrementDurations(EntityStore& entities, float timeDelta);
+void recordSwarmStats(const EntityStore& entities, SwarmStats& stats);
@@ -0,0 +1,188 @@
+#include "EventSimulator.h"
+#include "EntityStore.h"
+#include "TargetPolicies.h"
+
+#include <queue>
+#include <cmath>
+#include <algorithm>
+
+bool SwarmEventLater::operator()(const SwarmEvent& a, const SwarmEvent& b) const {
+    if (a.step != b.step) {
+        return a.step > b.step;
+    }
+    if (a.type != b.type) {
+        return a.type > b.type;
+    }
+    return a.index > b.index;
+}
+
+// number of iterations of the time loop in RunSim that start before the given time
+int64_t getStepCount(float time, const SimParameters& parameters) {
+    if (parameters.timeDelta <= 0) {
+        throw std::invalid_argument("time delta has to be positive");
+    }
+    return static_cast<int64_t>(std::ceil(static_cast<double>(time) / parameters.timeDelta));
+}
+
+int64_t getSimStepCount(const SimParameters& parameters) {
+    return getStepCount(parameters.simTime, parameters);
+}
+
+// step of the n-th cast, the cooldown starts at g_cooldown and the leftover of a step is carried over to the next cooldown
+int64_t getCastStep(int64_t castNumber, const SimParameters& parameters) {
+    return static_cast<int64_t>(std::ceil(castNumber * static_cast<double>(parameters.g_cooldown) / parameters.timeDelta));
+}
+
+// number of steps a swarm needs to count its timeToArrival up to 0 (see advanceTime)
+int64_t getTravelSteps(float travelTime, const SimParameters& parameters) {
+    double exactSteps = static_cast<double>(travelTime) / parameters.timeDelta;
+    int64_t steps = static_cast<int64_t>(std::ceil(exactSteps));
+    // the float sum of advanceTime rounds every add by at most 2^-24 * travelTime,
+    // only if that can push it over a step boundary the float sum is repeated
+    double maxError = (steps + 1) * static_cast<double>(travelTime) * (1.0 / 16777216.0) / parameters.timeDelta;
+    if (steps - exactSteps > maxError && exactSteps - (steps - 1) > maxError) {
+        return steps;
+    }
+    float timeToArrival = -travelTime;
+    steps = 0;
+    while (timeToArrival < 0) {
+        timeToArrival += parameters.timeDelta;
+        steps++;
+    }
+    return steps;
+}
+
+// number of decrements until a duration runs out, uses the same float arithmetic as advanceTime
+int64_t getDurationSteps(float duration, const SimParameters& parameters) {
+    if (parameters.timeDelta <= 0) {
+        throw std::invalid_argument("time delta has to be positive");
+    }
+    int64_t steps = 0;
+    while (duration > 0) {
+        duration -= parameters.timeDelta;
+        steps++;
+    }
+    return steps;
+}
+
+namespace {
+    // the queue of the event loop, a CHAIN table reads the pending arrivals at a cast
+    struct SwarmEventQueue : std::priority_queue<SwarmEvent, std::vector<SwarmEvent>, SwarmEventLater> {
+        const std::vector<SwarmEvent>& getEvents() const {
+            return c;
+        }
+    };
+}
+
+// event loop of runEventSim, instantiated per target policy
+template<typename Policy, typename EntityContainer>
+void runPolicyEventSim(EntityContainer& entities, SwarmStats& stats, const SimParameters& parameters, int64_t firstTickStep) {
+    const int64_t stepCount = getSimStepCount(parameters);
+    const float maxDuration = parameters.hasCircle ? parameters.g_maxDuration * 0.75f : parameters.g_maxDuration;
+    // the arrival step already decrements the fresh duration once
+    const int64_t durationSteps = getDurationSteps(maxDuration, parameters);
+
+    SwarmEventQueue events;
+    // first step an entity counts ticks (-1 if it has no stacks) and the step its current debuff/buff runs out (-1 if none)
+    // refreshed entities leave their old expiration in the queue, it is skipped when it doesn't match expirationSteps anymore
+    std::vector<int64_t> activeSince(entities.size, -1);
+    std::vector<int64_t> expirationSteps(entities.size, -1);
+    std::vector<TravelingSwarm> newSwarms;
+
+    for (int index = 0; index < entities.size; index++) {
+        auto&& e = entities[index];
+        if (e.stacks > 0) {
+            activeSince[index] = 1;
+        }
+        if (e.duration > 0) {
+            expirationSteps[index] = getDurationSteps(e.duration, parameters);
+            events.push({ expirationSteps[index], SwarmEventType::EXPIRATION, index, 0 });
+        }
+    }
+    int64_t castCount = 1;
+    events.push({ getCastStep(castCount, parameters), SwarmEventType::CAST, 0, 0 });
+
+    // ticks of the steps [fromStep, toStep), steps before firstTickStep are not recorded
+    auto addTicks = [&](int index, int64_t fromStep, int64_t toStep) {
+        int64_t ticks = toStep - std::max(fromStep, firstTickStep);
+        if (ticks <= 0) {
+            return;
+        }
+        if (index < entities.g_size) {
+            stats.friendlyTicks += (int)ticks;
+        }
+        else {
+            stats.enemyTicks += (int)ticks;
+        }
+    };
+    // swarms that are cast start traveling in the same step, propagated swarms are added after the arrivals of the step and start in the next one
+    auto scheduleSwarms = [&](int64_t firstStep) {
+        for (auto& swarm : newSwarms) {
+            events.push({ firstStep + getTravelSteps(swarm.travelTime, parameters), SwarmEventType::ARRIVAL, swarm.targetIndex, swarm.stacks });
+        }
+        newSwarms.clear();
+    };
+
+    while (!events.empty() && events.top().step <= stepCount) {
+        SwarmEvent event = events.top();
+        events.pop();
+        switch (event.type) {
+        case SwarmEventType::CAST: {
+            castObservedSwarm<Policy>(entities, newSwarms, stats, parameters, [&](CastObservation& observation) {
+                for (int index = 0; index < entities.size; index++) {
+                    if (expirationSteps[index] >= 0) {
+                        observation.remaining[index] = (expirationSteps[index] - event.step) * parameters.timeDelta;
+                    }
+                }
+                for (const SwarmEvent& pending : events.getEvents()) {
+                    if (pending.type == SwarmEventType::ARRIVAL) {
+                        observation.swarms.push_back({ pending.index, pending.stacks, (pending.step - event.step) * parameters.timeDelta });
+                    }
+                }
+            });
+            scheduleSwarms(event.step);
+            castCount++;
+            events.push({ getCastStep(castCount, parameters), SwarmEventType::CAST, 0, 0 });
+        }break;
+        case SwarmEventType::ARRIVAL: {
+            auto&& e = entities[event.index];
+            if (activeSince[event.index] < 0) {
+                activeSince[event.index] = event.step;
+            }
+            e.duration = maxDuration;
+            setStacks(entities, event.index, std::min(e.stacks + event.stacks, 5));
+            expirationSteps[event.index] = event.step + durationSteps - 1;
+            events.push({ expirationSteps[event.index], SwarmEventType::EXPIRATION, event.index, 0 });
+        }break;
+        case SwarmEventType::EXPIRATION: {
+            if (expirationSteps[event.index] != event.step) {
+                break;
+            }
+            expireSwarm(event.index, entities, newSwarms, parameters);
+            entities[event.index].duration = 0;
+            expirationSteps[event.index] = -1;
+            if (activeSince[event.index] >= 0) {
+                addTicks(event.index, activeSince[event.index], event.step);
+                activeSince[event.index] = -1;
+            }
+            scheduleSwarms(event.step + 1);
+        }break;
+        }
+    }
+
+    for (int index = 0; index < entities.size; index++) {
+        if (activeSince[index] >= 0) {
+            addTicks(index, activeSince[index], stepCount + 1);
+        }
+    }
+}
+
+template<typename EntityContainer>
+void runEventSim(EntityContainer& entities, const TargetStrategy strategy, SwarmStats& stats, const SimParameters& parameters, int64_t firstTickStep) {
+    visitTargetPolicy(strategy, [&](auto policy) {
+        runPolicyEventSim<decltype(policy)>(entities, stats, parameters, firstTickStep);
+    });
+}
+
+template void runEventSim(Entities& entities, const TargetStrategy strategy, SwarmStats& stats, const SimParameters& parameters, int64_t firstTickStep);
+template void runEventSim(EntityStore& entities, const TargetStrategy strategy, SwarmStats& stats, const SimParameters& parameters, int64_t firstTickStep);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "WowSwarmSimulator.h"
+
+// event driven version of the fixed step loop of RunSim:
+// the fixed step loop spends almost all of its steps decrementing durations and counting ticks,
+// the state only changes when a swarm is cast, a swarm arrives or a debuff/buff runs out.
+// every event is scheduled on the step grid of the fixed step loop (step k = k-th loop iteration, starting at 1)
+// and events of the same step are handled in the same order as in the loop (cast, arrivals, expirations by entity index)
+// so the random draws happen in the same order and the ticks are counted per step like recordSwarmStats does.
+
+enum class SwarmEventType {
+    CAST, ARRIVAL, EXPIRATION
+};
+
+struct SwarmEvent {
+    int64_t step = 0;
+    SwarmEventType type = SwarmEventType::CAST;
+    int index = 0;
+    int stacks = 0;
+};
+
+// orders the priority queue by step, then event type, then entity index (earliest on top)
+struct SwarmEventLater {
+    bool operator()(const SwarmEvent& a, const SwarmEvent& b) const;
+};
+
+int64_t getStepCount(float time, const SimParameters& parameters);
+int64_t getSimStepCount(const SimParameters& parameters);
+int64_t getCastStep(int64_t castNumber, const SimParameters& parameters);
+int64_t getTravelSteps(float travelTime, const SimParameters& parameters);
+int64_t getDurationSteps(float duration, const SimParameters& parameters);
+template<typename EntityContainer>
+void runEventSim(EntityContainer& entities, const TargetStrategy strategy, SwarmStats& stats, const SimParameters& parameters, int64_t firstTickStep = 1);
@@ -0,0 +1,162 @@
+#include "LaneSimulator.h"
+#include "EventSimulator.h"
+#include "EntityStore.h"
+#include "SwarmQueue.h"
+#include "TargetPolicies.h"
+#include "SimRng.h"
+
+#include <vector>
+#include <utility>
+#include <emmintrin.h>
+
+namespace {
+    constexpr int lanesPerVector = 4;
+    constexpr int vectorsPerEntity = simLaneCount / lanesPerVector;
+    static_assert(simLaneCount % lanesPerVector == 0, "lanes have to fill whole SSE2 vectors");
+
+    struct SimLanes {
+        std::vector<int32_t> remainingSteps;
+        // lanes whose debuff/buff ran out in this step, per entity
+        std::vector<uint32_t> expiredLanes;
+        std::vector<EntityStore> entities;
+        std::array<SwarmQueue, simLaneCount> swarms;
+        std::array<SimRng, simLaneCount> rngs;
+
+        SimLanes(size_t friendlyCount, size_t enemyCount) {
+            remainingSteps.resize((friendlyCount + enemyCount) * simLaneCount, 0);
+            expiredLanes.resize(friendlyCount + enemyCount, 0);
+            entities.resize(simLaneCount, EntityStore{ friendlyCount, enemyCount });
+        }
+    };
+
+    // runs f with the rng of the lane as the rng of the thread (castSwarm and expireSwarm draw from it)
+    template<typename Function>
+    void runOnLane(SimLanes& lanes, int lane, Function&& f) {
+        std::swap(rng, lanes.rngs[lane]);
+        f();
+        std::swap(rng, lanes.rngs[lane]);
+    }
+
+    // decrements the running durations of all lanes and adds the entities that still have stacks to the tick counters,
+    // returns whether any lane had an expiration
+    bool decrementLaneDurations(SimLanes& lanes, size_t g_size, __m128i* friendlyTicks, __m128i* enemyTicks, bool recordTicks) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i record = recordTicks ? _mm_set1_epi32(-1) : zero;
+        uint32_t anyExpired = 0;
+        int32_t* remaining = lanes.remainingSteps.data();
+        for (size_t index = 0; index < lanes.expiredLanes.size(); index++) {
+            uint32_t expired = 0;
+            __m128i* ticks = index < g_size ? friendlyTicks : enemyTicks;
+            for (int v = 0; v < vectorsPerEntity; v++) {
+                __m128i* steps = reinterpret_cast<__m128i*>(remaining + index * simLaneCount + v * lanesPerVector);
+                __m128i duration = _mm_loadu_si128(steps);
+                // active lanes are -1, so adding the mask decrements exactly them
+                __m128i active = _mm_cmpgt_epi32(duration, zero);
+                duration = _mm_add_epi32(duration, active);
+                _mm_storeu_si128(steps, duration);
+                __m128i stillActive = _mm_cmpgt_epi32(duration, zero);
+                ticks[v] = _mm_sub_epi32(ticks[v], _mm_and_si128(stillActive, record));
+                __m128i runOut = _mm_andnot_si128(stillActive, active);
+                expired |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(runOut))) << (v * lanesPerVector);
+            }
+            lanes.expiredLanes[index] = expired;
+            anyExpired |= expired;
+        }
+        return anyExpired != 0;
+    }
+
+    template<typename Policy>
+    void runLaneLoop(SimLanes& lanes, size_t g_size, const SimParameters& parameters, int64_t firstTickStep, LaneStats& stats) {
+        const int64_t stepCount = getSimStepCount(parameters);
+        const float maxDuration = parameters.hasCircle ? parameters.g_maxDuration * 0.75f : parameters.g_maxDuration;
+        const int32_t durationSteps = (int32_t)getDurationSteps(maxDuration, parameters);
+        // per lane tick counters, 4 lanes per vector
+        __m128i friendlyTicks[vectorsPerEntity];
+        __m128i enemyTicks[vectorsPerEntity];
+        for (int v = 0; v < vectorsPerEntity; v++) {
+            friendlyTicks[v] = _mm_setzero_si128();
+            enemyTicks[v] = _mm_setzero_si128();
+        }
+
+        int64_t castCount = 1;
+        int64_t nextCastStep = getCastStep(castCount, parameters);
+        for (int64_t step = 1; step <= stepCount; step++) {
+            if (step == nextCastStep) {
+                for (int lane = 0; lane < simLaneCount; lane++) {
+                    runOnLane(lanes, lane, [&]() {
+                        castObservedSwarm<Policy>(lanes.entities[lane], lanes.swarms[lane].launched, stats[lane], parameters, [&](CastObservation& observation) {
+                            // the duration is decremented once more in this step
+                            for (size_t index = 0; index < lanes.expiredLanes.size(); index++) {
+                                int32_t remaining = lanes.remainingSteps[index * simLaneCount + lane];
+                                observation.remaining[index] = remaining > 0 ? (remaining - 1) * parameters.timeDelta : 0.0f;
+                            }
+                            for (const QueuedSwarm& swarm : lanes.swarms[lane].getQueued()) {
+                                observation.swarms.push_back({ swarm.targetIndex, swarm.stacks, (swarm.arrivalStep - step) * parameters.timeDelta });
+                            }
+                        });
+                    });
+                    lanes.swarms[lane].schedule(step, parameters);
+                }
+                castCount++;
+                nextCastStep = getCastStep(castCount, parameters);
+            }
+
+            for (int lane = 0; lane < simLaneCount; lane++) {
+                SwarmQueue& swarms = lanes.swarms[lane];
+                EntityStore& entities = lanes.entities[lane];
+                while (swarms.hasArrival(step)) {
+                    QueuedSwarm swarm = swarms.popArrival();
+                    lanes.remainingSteps[swarm.targetIndex * simLaneCount + lane] = durationSteps;
+                    int stacks = entities.stacks[swarm.targetIndex] + swarm.stacks;
+                    setStacks(entities, swarm.targetIndex, stacks > 5 ? 5 : stacks);
+                }
+            }
+
+            if (decrementLaneDurations(lanes, g_size, friendlyTicks, enemyTicks, step >= firstTickStep)) {
+                uint32_t expiredAny = 0;
+                for (size_t index = 0; index < lanes.expiredLanes.size(); index++) {
+                    for (uint32_t expired = lanes.expiredLanes[index]; expired; expired &= expired - 1) {
+                        int lane = findLowestBit(expired);
+                        runOnLane(lanes, lane, [&]() {
+                            expireSwarm((int)index, lanes.entities[lane], lanes.swarms[lane].launched, parameters);
+                        });
+                    }
+                    expiredAny |= lanes.expiredLanes[index];
+                }
+                for (; expiredAny; expiredAny &= expiredAny - 1) {
+                    lanes.swarms[findLowestBit(expiredAny)].schedule(step + 1, parameters);
+                }
+            }
+        }
+
+        std::array<int32_t, simLaneCount> laneTicks;
+        for (int v = 0; v < vectorsPerEntity; v++) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(laneTicks.data() + v * lanesPerVector), friendlyTicks[v]);
+        }
+        for (int lane = 0; lane < simLaneCount; lane++) {
+            stats[lane].friendlyTicks += laneTicks[lane];
+        }
+        for (int v = 0; v < vectorsPerEntity; v++) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(laneTicks.data() + v * lanesPerVector), enemyTicks[v]);
+        }
+        for (int lane = 0; lane < simLaneCount; lane++) {
+            stats[lane].enemyTicks += laneTicks[lane];
+        }
+    }
+}
+
+// the sweep always starts empty, so every lane starts with an empty store and queue
+void runSwarmSimLanes(size_t friendlyCount, size_t enemyCount, const TargetStrategy strategy, const SimParameters& parameters, float warmupTime,
+    uint64_t seed, uint32_t config, uint32_t firstReplica, LaneStats& stats) {
+    SimLanes lanes{ friendlyCount, enemyCount };
+    for (int lane = 0; lane < simLaneCount; lane++) {
+        lanes.rngs[lane] = SimRng(seed, config, firstReplica + lane);
+        stats[lane] = SwarmStats();
+        stats[lane].simTime = parameters.simTime - warmupTime;
+    }
+
+    int64_t firstTickStep = getStepCount(warmupTime, parameters) + 1;
+    visitTargetPolicy(strategy, [&](auto policy) {
+        runLaneLoop<decltype(policy)>(lanes, friendlyCount, parameters, firstTickStep, stats);
+    });
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "WowSwarmSimulator.h"
+
+// fixed step loop of runSwarmSim for simLaneCount independent replicas of the same configuration at once:
+// the remaining durations are integer steps (see getDurationSteps) interleaved per entity, [entity * simLaneCount + lane],
+// so the per step work (decrement, expiry masks, tick counting) of all replicas is a few SSE2 instructions per entity.
+// casts, arrivals and expirations are rare and handled per lane with the lane's own EntityStore (stacks), SwarmQueue and rng.
+// all replicas share the cast steps, lane l uses the rng stream (seed, config, firstReplica + l), so its statistics are the same
+// as runSwarmSim with seedSimRng(seed, config, firstReplica + l).
+
+constexpr int simLaneCount = 8;
+typedef std::array<SwarmStats, simLaneCount> LaneStats;
+
+void runSwarmSimLanes(size_t friendlyCount, size_t enemyCount, const TargetStrategy strategy, const SimParameters& parameters, float warmupTime,
+    uint64_t seed, uint32_t config, uint32_t firstReplica, LaneStats& stats);
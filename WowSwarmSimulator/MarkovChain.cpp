@@ -0,0 +1,837 @@
+#include "MarkovChain.h"
+#include "EntityStore.h"
+#include "TargetPolicies.h"
+
+#include <array>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t maxChainEntities = 2 * maxChainSideEntities;
+    // arrival bins of the traveling swarms, so the bin width has to be at least g_maxTraveltime / 15.5
+    constexpr size_t maxTravelBins = 16;
+
+    // stacks, bins until the stacks expire (0 = they expire at the start of the next bin) and the stacks of the swarms
+    // that arrive at the entity after 0, 1, ... bins (swarms that arrive at the same entity in the same bin are merged,
+    // the stacks are capped at 5 either way). a byte array so equal entities compare equal and the states can be sorted
+    typedef std::array<uint8_t, 2 + maxTravelBins> ChainEntity;
+    constexpr size_t stacksByte = 0;
+    constexpr size_t remainingByte = 1;
+    constexpr size_t incomingByte = 2;
+
+    struct ChainState {
+        // bins until the next cast (0 = the swarm is cast in this bin)
+        int phase = 0;
+        std::array<ChainEntity, maxChainEntities> entities{};
+    };
+
+    struct Branch {
+        ChainState state;
+        double probability = 0.0;
+    };
+
+    // entity index and probability, identical entities of a state are merged into one target
+    typedef std::vector<std::pair<int, double>> TargetProbabilities;
+
+    struct ChainModel {
+        size_t friendlyCount = 0;
+        size_t entityCount = 0;
+        int castPeriod = 0;
+        uint8_t durationBins = 0;
+        // probability that a swarm arrives after 0, 1, ... bins, cast swarms leave at the start of their bin
+        // and propagated swarms somewhere in it (see getTravelBinProbabilities)
+        std::vector<double> castTravelBins;
+        std::vector<double> propagationTravelBins;
+        double singleChance = 0.0;
+        // FOCUS strategies always cast on the first entity of their side, that entity keeps its index when the state is sorted
+        int pinned = -1;
+    };
+
+    bool isIdle(const ChainEntity& entity) {
+        return std::all_of(entity.begin(), entity.end(), [](uint8_t b) { return b == 0; });
+    }
+
+    int getSide(const ChainModel& model, int index) {
+        return index >= (int)model.friendlyCount;
+    }
+
+    // the entities of a side are interchangeable for the swarms (propagation draws uniformly and the strategies are
+    // applied per target class, see evaluateMarkovChain), so every side is sorted and the idle entities at its end are left out of the key
+    std::string encodeState(ChainState& state, const ChainModel& model) {
+        const size_t entityBytes = 2 + model.propagationTravelBins.size();
+        std::string key;
+        key.reserve(2 + 2 + 8 * entityBytes);
+        key.push_back((char)(state.phase & 0xff));
+        key.push_back((char)(state.phase >> 8));
+        for (int side = 0; side < 2; side++) {
+            size_t first = side ? model.friendlyCount : 0;
+            size_t last = side ? model.entityCount : model.friendlyCount;
+            size_t sorted = first + (model.pinned == (int)first);
+            std::sort(state.entities.begin() + sorted, state.entities.begin() + last, std::greater<ChainEntity>());
+            size_t stored = last;
+            while (stored > sorted && isIdle(state.entities[stored - 1])) {
+                stored--;
+            }
+            key.push_back((char)(stored - first));
+            for (size_t index = first; index < stored; index++) {
+                key.append((const char*)state.entities[index].data(), entityBytes);
+            }
+        }
+        return key;
+    }
+
+    ChainState decodeState(const std::string& key, const ChainModel& model) {
+        const size_t entityBytes = 2 + model.propagationTravelBins.size();
+        ChainState state;
+        state.phase = (uint8_t)key[0] | (uint8_t)key[1] << 8;
+        size_t position = 2;
+        for (int side = 0; side < 2; side++) {
+            size_t first = side ? model.friendlyCount : 0;
+            size_t stored = (uint8_t)key[position++];
+            for (size_t index = first; index < first + stored; index++) {
+                std::copy_n((const uint8_t*)key.data() + position, entityBytes, state.entities[index].begin());
+                position += entityBytes;
+            }
+        }
+        return state;
+    }
+
+    // uniform choice between the candidates, identical entities lead to the same sorted state and are merged
+    void addUniformTargets(const ChainState& state, const std::vector<int>& candidates, TargetProbabilities& targets) {
+        targets.clear();
+        for (int index : candidates) {
+            auto same = std::find_if(targets.begin(), targets.end(), [&](const std::pair<int, double>& target) {
+                return state.entities[target.first] == state.entities[index];
+            });
+            if (same != targets.end()) {
+                same->second += 1.0 / candidates.size();
+            }
+            else {
+                targets.push_back({ index, 1.0 / candidates.size() });
+            }
+        }
+    }
+
+    // propagateSwarm: a random entity without stacks of the other side, any entity of the side if all have stacks
+    void getPropagationTargets(const ChainState& state, bool wasFriendly, const ChainModel& model, TargetProbabilities& targets) {
+        size_t first = wasFriendly ? model.friendlyCount : 0;
+        size_t last = wasFriendly ? model.entityCount : model.friendlyCount;
+        std::vector<int> candidates;
+        for (size_t index = first; index < last; index++) {
+            if (state.entities[index][stacksByte] == 0) {
+                candidates.push_back((int)index);
+            }
+        }
+        if (candidates.empty()) {
+            for (size_t index = first; index < last; index++) {
+                candidates.push_back((int)index);
+            }
+        }
+        addUniformTargets(state, candidates, targets);
+    }
+
+    // the entities of the target class (side * 6 + stacks), the strategies pick one of them by index but the chain doesn't keep indices
+    void getClassTargets(const ChainState& state, int targetClass, const ChainModel& model, TargetProbabilities& targets) {
+        std::vector<int> candidates;
+        for (size_t index = 0; index < model.entityCount; index++) {
+            if (getSide(model, (int)index) == targetClass / 6 && state.entities[index][stacksByte] == targetClass % 6) {
+                candidates.push_back((int)index);
+            }
+        }
+        addUniformTargets(state, candidates, targets);
+    }
+
+    // every branch sends a swarm with the given stacks to every target with every travel bin
+    void launchSwarms(std::vector<Branch>& branches, const TargetProbabilities& targets, int stacks, const std::vector<double>& travelBins) {
+        std::vector<Branch> launched;
+        launched.reserve(branches.size() * targets.size() * travelBins.size());
+        for (const Branch& branch : branches) {
+            for (auto& target : targets) {
+                for (size_t travel = 0; travel < travelBins.size(); travel++) {
+                    if (travelBins[travel] == 0.0) {
+                        continue;
+                    }
+                    Branch b = branch;
+                    b.probability *= target.second * travelBins[travel];
+                    uint8_t& incoming = b.state.entities[target.first][incomingByte + travel];
+                    incoming = (uint8_t)std::min(incoming + stacks, 5);
+                    launched.push_back(b);
+                }
+            }
+        }
+        std::swap(branches, launched);
+    }
+
+    // expireSwarm of an entity in every branch, the propagated swarms start traveling right away.
+    // the expiration and a swarm that arrives at the entity in the same bin are in either order with the same chance:
+    // the swarm refreshes the stacks before they run out, or it lands on the entity after the stacks propagated
+    void expireBranches(std::vector<Branch>& branches, int index, const ChainModel& model) {
+        std::vector<Branch> expired;
+        TargetProbabilities targets;
+        for (Branch& branch : branches) {
+            ChainEntity& entity = branch.state.entities[index];
+            int stacks = entity[stacksByte];
+            if (entity[incomingByte] > 0) {
+                Branch refreshed = branch;
+                refreshed.probability *= 0.5;
+                ChainEntity& e = refreshed.state.entities[index];
+                e[stacksByte] = (uint8_t)std::min(e[stacksByte] + e[incomingByte], 5);
+                e[remainingByte] = model.durationBins;
+                e[incomingByte] = 0;
+                expired.push_back(refreshed);
+                branch.probability *= 0.5;
+            }
+            entity[stacksByte] = 0;
+            if (stacks <= 1) {
+                expired.push_back(branch);
+                continue;
+            }
+            getPropagationTargets(branch.state, getSide(model, index) == 0, model, targets);
+            std::vector<Branch> single{ branch };
+            launchSwarms(single, targets, stacks - 1, model.propagationTravelBins);
+            // the second swarm draws from the same entities, but the first one may have made two of them different
+            std::vector<Branch> split;
+            for (const Branch& b : single) {
+                std::vector<Branch> second{ b };
+                getPropagationTargets(b.state, getSide(model, index) == 0, model, targets);
+                launchSwarms(second, targets, stacks - 1, model.propagationTravelBins);
+                split.insert(split.end(), second.begin(), second.end());
+            }
+            for (Branch& b : single) {
+                b.probability *= model.singleChance;
+                expired.push_back(b);
+            }
+            for (Branch& b : split) {
+                b.probability *= 1.0 - model.singleChance;
+                expired.push_back(b);
+            }
+        }
+        std::swap(branches, expired);
+    }
+
+    // one bin from a state: the swarm of the cast bin is sent to the target class (or the pinned entity) at the start of the bin,
+    // then the stacks that run out in the bin expire (friendlies first, like advanceTime) and the swarms of the bin arrive
+    void advanceState(const ChainState& state, int targetClass, const ChainModel& model, std::vector<Branch>& branches) {
+        branches.clear();
+        branches.push_back({ state, 1.0 });
+        if (state.phase == 0) {
+            TargetProbabilities targets;
+            if (model.pinned >= 0) {
+                targets.assign(1, { model.pinned, 1.0 });
+            }
+            else {
+                getClassTargets(state, targetClass, model, targets);
+            }
+            launchSwarms(branches, targets, 3, model.castTravelBins);
+        }
+        for (size_t index = 0; index < model.entityCount; index++) {
+            if (state.entities[index][stacksByte] > 0 && state.entities[index][remainingByte] == 0) {
+                expireBranches(branches, (int)index, model);
+            }
+        }
+        for (Branch& branch : branches) {
+            ChainState& s = branch.state;
+            for (size_t index = 0; index < model.entityCount; index++) {
+                ChainEntity& entity = s.entities[index];
+                if (entity[incomingByte] > 0) {
+                    entity[stacksByte] = (uint8_t)std::min(entity[stacksByte] + entity[incomingByte], 5);
+                    entity[remainingByte] = model.durationBins;
+                }
+                std::copy(entity.begin() + incomingByte + 1, entity.end(), entity.begin() + incomingByte);
+                entity.back() = 0;
+                if (entity[remainingByte] > 0) {
+                    entity[remainingByte]--;
+                }
+            }
+            s.phase = state.phase == 0 ? model.castPeriod - 1 : state.phase - 1;
+        }
+    }
+
+    // the reachable states of the chain and their transitions as a sparse matrix (compressed rows).
+    // a cast state has one row per target class it contains (one row with a pinned target), every other state a single row
+    struct ChainGraph {
+        std::vector<size_t> rowStart{ 0 };
+        std::vector<uint8_t> rowClass;
+        std::vector<size_t> edgeStart{ 0 };
+        std::vector<uint32_t> successors;
+        std::vector<double> probabilities;
+        // entities with stacks at the start of the bin of the state
+        std::vector<uint8_t> friendlyActive;
+        std::vector<uint8_t> enemyActive;
+        // states per phase
+        std::vector<std::vector<uint32_t>> phaseStates;
+        // entities per target class (side * 6 + stacks) and keys of the cast states, same order as phaseStates[0]
+        std::vector<std::array<uint8_t, 12>> castClasses;
+        std::vector<std::string> castKeys;
+    };
+
+    // breadth first search from the empty state at the start of the sim (state 0)
+    ChainGraph buildChainGraph(const ChainModel& model, size_t maxStates) {
+        ChainGraph graph;
+        graph.phaseStates.resize(model.castPeriod);
+        std::unordered_map<std::string, uint32_t> ids;
+        std::vector<std::string> keys;
+        auto getId = [&](ChainState& state) {
+            std::string key = encodeState(state, model);
+            auto inserted = ids.emplace(key, (uint32_t)keys.size());
+            if (inserted.second) {
+                if (keys.size() >= maxStates) {
+                    throw std::logic_error("Markov chain exceeds " + std::to_string(maxStates) + " states");
+                }
+                uint8_t friendly = 0;
+                uint8_t enemy = 0;
+                for (size_t index = 0; index < model.entityCount; index++) {
+                    if (state.entities[index][stacksByte] > 0) {
+                        (getSide(model, (int)index) ? enemy : friendly)++;
+                    }
+                }
+                graph.friendlyActive.push_back(friendly);
+                graph.enemyActive.push_back(enemy);
+                graph.phaseStates[state.phase].push_back((uint32_t)keys.size());
+                keys.push_back(std::move(key));
+            }
+            return inserted.first->second;
+        };
+
+        ChainState empty;
+        getId(empty);
+        std::vector<Branch> branches;
+        std::vector<std::pair<uint32_t, double>> row;
+        auto addRow = [&](int targetClass) {
+            row.clear();
+            for (Branch& branch : branches) {
+                row.push_back({ getId(branch.state), branch.probability });
+            }
+            std::sort(row.begin(), row.end());
+            for (size_t i = 0; i < row.size(); i++) {
+                if (i > 0 && row[i].first == row[i - 1].first) {
+                    graph.probabilities.back() += row[i].second;
+                }
+                else {
+                    graph.successors.push_back(row[i].first);
+                    graph.probabilities.push_back(row[i].second);
+                }
+            }
+            graph.edgeStart.push_back(graph.successors.size());
+            graph.rowClass.push_back((uint8_t)targetClass);
+        };
+        for (size_t id = 0; id < keys.size(); id++) {
+            ChainState state = decodeState(keys[id], model);
+            if (state.phase == 0) {
+                graph.castKeys.push_back(keys[id]);
+            }
+            // the key is only needed once, the map keeps its own copy
+            std::string().swap(keys[id]);
+            if (state.phase == 0) {
+                // the states are expanded in id order, the order of phaseStates
+                std::array<uint8_t, 12>& classes = graph.castClasses.emplace_back();
+                classes.fill(0);
+                for (size_t index = 0; index < model.entityCount; index++) {
+                    classes[getSide(model, (int)index) * 6 + state.entities[index][stacksByte]]++;
+                }
+                for (int targetClass = 0; targetClass < 12; targetClass++) {
+                    bool isPinnedClass = model.pinned >= 0 && targetClass == getSide(model, model.pinned) * 6 + state.entities[model.pinned][stacksByte];
+                    if (model.pinned >= 0 ? isPinnedClass : classes[targetClass] > 0) {
+                        advanceState(state, targetClass, model, branches);
+                        addRow(targetClass);
+                    }
+                }
+            }
+            else {
+                advanceState(state, -1, model, branches);
+                addRow(-1);
+            }
+            graph.rowStart.push_back(graph.rowClass.size());
+        }
+        return graph;
+    }
+
+    typedef std::vector<std::pair<int, double>> ClassProbabilities;
+
+    void addSideTargets(const EntityStore& entities, EntitySide side, TargetProbabilities& targets) {
+        int first = side == EntitySide::ENEMY ? (int)entities.g_size : 0;
+        int count = side == EntitySide::ENEMY ? (int)entities.e_size : side == EntitySide::FRIENDLY ? (int)entities.g_size : (int)entities.size;
+        for (int index = first; index < first + count; index++) {
+            targets.push_back({ index, 1.0 / count });
+        }
+    }
+
+    // castSwarm<Policy> with the random draws enumerated, the states without a table entry enumerate the base strategy of the table
+    template<typename Policy>
+    void getCastTargets(EntityStore& entities, TargetProbabilities& targets) {
+        if constexpr (std::is_same_v<Policy, TableTarget>) {
+            int index = TableTarget::selectTableTarget(entities);
+            if (index >= 0) {
+                targets.push_back({ index, 1.0 });
+                return;
+            }
+            visitTargetPolicy(TableTarget::getBaseStrategy(), [&](auto policy) {
+                getCastTargets<decltype(policy)>(entities, targets);
+            });
+        }
+        else if constexpr (Policy::isRandom) {
+            addSideTargets(entities, Policy::side, targets);
+        }
+        else {
+            int index = Policy::selectTarget(entities);
+            if constexpr (Policy::hasFallback) {
+                if (index < 0) {
+                    getCastTargets<typename Policy::Fallback>(entities, targets);
+                    return;
+                }
+            }
+            targets.push_back({ index, 1.0 });
+        }
+    }
+
+    // target classes the strategy picks in every cast state: the strategies only look at the stacks per side,
+    // so a store with the stacks of the state decides the class and the chain spreads the cast over the entities of the class
+    template<typename Policy>
+    std::vector<ClassProbabilities> getCastClasses(const ChainGraph& graph, const ChainModel& model, size_t enemyCount) {
+        std::vector<ClassProbabilities> castClasses(graph.castClasses.size());
+        EntityStore entities{ model.friendlyCount, enemyCount };
+        TargetProbabilities targets;
+        for (size_t i = 0; i < graph.castClasses.size(); i++) {
+            int index = 0;
+            for (int targetClass = 0; targetClass < 12; targetClass++) {
+                for (int n = 0; n < graph.castClasses[i][targetClass]; n++) {
+                    setStacks(entities, index++, targetClass % 6);
+                }
+            }
+            targets.clear();
+            getCastTargets<Policy>(entities, targets);
+            for (auto& target : targets) {
+                int targetClass = (target.first >= (int)model.friendlyCount) * 6 + entities.stacks[target.first];
+                auto same = std::find_if(castClasses[i].begin(), castClasses[i].end(), [&](const std::pair<int, double>& c) { return c.first == targetClass; });
+                if (same != castClasses[i].end()) {
+                    same->second += target.second;
+                }
+                else {
+                    castClasses[i].push_back({ targetClass, target.second });
+                }
+            }
+        }
+        return castClasses;
+    }
+
+    // power iteration of the period map: the distribution is pushed through the sparse matrix one cooldown period at a time
+    // until the distribution at the start of the period doesn't change anymore, then the ticks of that period are the stationary ticks.
+    // the cast states mix their rows with the class probabilities of the strategy (a pinned graph has a single cast row)
+    ChainResult iterateChain(const ChainGraph& graph, const std::vector<ClassProbabilities>& castClasses, const ChainModel& model, double tolerance) {
+        std::vector<double> distribution(graph.friendlyActive.size(), 0.0);
+        distribution[0] = 1.0;
+        const std::vector<uint32_t>& periodStates = graph.phaseStates[0];
+        std::vector<double> periodStart(periodStates.size(), 0.0);
+
+        ChainResult result;
+        result.stateCount = graph.friendlyActive.size();
+        // the stacks arrive and expire somewhere in the bin, an entity that has stacks at one end of the bin ticks half of it
+        auto pushRow = [&](uint32_t id, size_t row, double probability, double& friendlyTicks, double& enemyTicks) {
+            friendlyTicks += 0.5 * probability * graph.friendlyActive[id];
+            enemyTicks += 0.5 * probability * graph.enemyActive[id];
+            for (size_t edge = graph.edgeStart[row]; edge < graph.edgeStart[row + 1]; edge++) {
+                uint32_t next = graph.successors[edge];
+                double p = probability * graph.probabilities[edge];
+                distribution[next] += p;
+                friendlyTicks += 0.5 * p * graph.friendlyActive[next];
+                enemyTicks += 0.5 * p * graph.enemyActive[next];
+            }
+        };
+        const int maxPeriods = 1000000;
+        for (int period = 1; period <= maxPeriods; period++) {
+            for (size_t i = 0; i < periodStates.size(); i++) {
+                periodStart[i] = distribution[periodStates[i]];
+            }
+            double friendlyTicks = 0.0;
+            double enemyTicks = 0.0;
+            std::array<double, 12> castShares{};
+            for (int step = 0; step < model.castPeriod; step++) {
+                int phase = step == 0 ? 0 : model.castPeriod - step;
+                const std::vector<uint32_t>& states = graph.phaseStates[phase];
+                for (size_t i = 0; i < states.size(); i++) {
+                    uint32_t id = states[i];
+                    double probability = distribution[id];
+                    if (probability == 0.0) {
+                        continue;
+                    }
+                    distribution[id] = 0.0;
+                    if (phase != 0 || model.pinned >= 0) {
+                        size_t row = graph.rowStart[id];
+                        if (phase == 0) {
+                            castShares[graph.rowClass[row]] += probability;
+                        }
+                        pushRow(id, row, probability, friendlyTicks, enemyTicks);
+                        continue;
+                    }
+                    for (auto& targetClass : castClasses[i]) {
+                        size_t row = graph.rowStart[id];
+                        while (graph.rowClass[row] != targetClass.first) {
+                            row++;
+                        }
+                        castShares[targetClass.first] += probability * targetClass.second;
+                        pushRow(id, row, probability * targetClass.second, friendlyTicks, enemyTicks);
+                    }
+                }
+            }
+
+            double change = 0.0;
+            for (size_t i = 0; i < periodStates.size(); i++) {
+                change += std::abs(distribution[periodStates[i]] - periodStart[i]);
+            }
+            // one tick per bin and entity with stacks, ticks * binWidth / (castPeriod * binWidth) seconds
+            result.friendlyTicksPerSecond = friendlyTicks / model.castPeriod;
+            result.enemyTicksPerSecond = enemyTicks / model.castPeriod;
+            result.ticksPerSecond = result.friendlyTicksPerSecond + result.enemyTicksPerSecond;
+            result.periods = period;
+            for (int target = 0; target < 12; target++) {
+                result.targetShares[target / 6][target % 6] = castShares[target];
+            }
+            if (change < tolerance) {
+                return result;
+            }
+        }
+        throw std::logic_error("Markov chain didn't converge");
+    }
+
+    template<typename Policy>
+    struct IsFocusTarget : std::false_type {};
+    template<EntitySide Side>
+    struct IsFocusTarget<FocusTarget<Side>> : std::true_type {};
+
+    // whole number of bins of a time, throws if the time isn't on the bin grid
+    int getBinCount(float time, float binWidth, const char* name) {
+        double bins = (double)time / binWidth;
+        if (std::abs(bins - std::round(bins)) > 1e-4 || std::round(bins) < 1.0) {
+            throw std::invalid_argument(std::string("the ") + name + " has to be a whole number of Markov chain bins");
+        }
+        return (int)std::round(bins);
+    }
+
+    ChainModel makeChainModel(size_t friendlyCount, size_t enemyCount, const SimParameters& parameters) {
+        if (friendlyCount < 1 || enemyCount < 1 || friendlyCount > maxChainSideEntities || enemyCount > maxChainSideEntities) {
+            throw std::invalid_argument("the Markov chain supports 1 to 5 entities per side");
+        }
+        if (!(parameters.chainBinWidth > 0.0f)) {
+            throw std::invalid_argument("the Markov chain bin width has to be positive");
+        }
+        ChainModel model;
+        model.friendlyCount = friendlyCount;
+        model.entityCount = friendlyCount + enemyCount;
+        model.castPeriod = getBinCount(parameters.g_cooldown, parameters.chainBinWidth, "cooldown");
+        const float maxDuration = parameters.hasCircle ? parameters.g_maxDuration * 0.75f : parameters.g_maxDuration;
+        int durationBins = getBinCount(maxDuration, parameters.chainBinWidth, "duration");
+        model.castTravelBins = getTravelBinProbabilities(parameters, false);
+        model.propagationTravelBins = getTravelBinProbabilities(parameters, true);
+        model.castTravelBins.resize(model.propagationTravelBins.size(), 0.0);
+        if (durationBins > 255 || model.propagationTravelBins.size() > maxTravelBins || model.castPeriod > 0xffff) {
+            throw std::invalid_argument("the Markov chain bin width is too small");
+        }
+        model.durationBins = (uint8_t)durationBins;
+        // expireSwarm propagates once if nextFloat() > g_splitChance
+        model.singleChance = std::clamp(1.0 - parameters.g_splitChance, 0.0, 1.0);
+        return model;
+    }
+
+    size_t findClassRow(const ChainGraph& graph, uint32_t id, int targetClass) {
+        size_t row = graph.rowStart[id];
+        while (graph.rowClass[row] != targetClass) {
+            row++;
+        }
+        return row;
+    }
+
+    // expected ticks of a row (trapezoid like iterateChain) plus the relative values of the successors
+    double getRowValue(const ChainGraph& graph, uint32_t id, size_t row, const std::vector<double>& values) {
+        double value = 0.5 * (graph.friendlyActive[id] + graph.enemyActive[id]);
+        for (size_t edge = graph.edgeStart[row]; edge < graph.edgeStart[row + 1]; edge++) {
+            uint32_t next = graph.successors[edge];
+            value += graph.probabilities[edge] * (0.5 * (graph.friendlyActive[next] + graph.enemyActive[next]) + values[next]);
+        }
+        return value;
+    }
+
+    // relative value iteration of a policy one period at a time: the phases before the cast are backed up from the cast states
+    // (phase 1 first), then the cast states with the classes of the policy. the change of the cast states converges to the gain of a period,
+    // the values are kept relative to the empty start state. returns the gain, values holds the relative values of all states
+    double evaluateChainPolicy(const ChainGraph& graph, const std::vector<ClassProbabilities>& castClasses, const ChainModel& model,
+        double tolerance, std::vector<double>& values) {
+        const std::vector<uint32_t>& castStates = graph.phaseStates[0];
+        std::vector<double> castValues(castStates.size());
+        const int maxPeriods = 1000000;
+        for (int period = 1; period <= maxPeriods; period++) {
+            for (int phase = 1; phase < model.castPeriod; phase++) {
+                for (uint32_t id : graph.phaseStates[phase]) {
+                    values[id] = getRowValue(graph, id, graph.rowStart[id], values);
+                }
+            }
+            double lowest = std::numeric_limits<double>::max();
+            double highest = std::numeric_limits<double>::lowest();
+            for (size_t i = 0; i < castStates.size(); i++) {
+                double value = 0.0;
+                for (auto& targetClass : castClasses[i]) {
+                    value += targetClass.second * getRowValue(graph, castStates[i], findClassRow(graph, castStates[i], targetClass.first), values);
+                }
+                castValues[i] = value;
+                lowest = std::min(lowest, value - values[castStates[i]]);
+                highest = std::max(highest, value - values[castStates[i]]);
+            }
+            // the empty state 0 is the first cast state
+            const double offset = castValues[0];
+            for (size_t i = 0; i < castStates.size(); i++) {
+                values[castStates[i]] = castValues[i] - offset;
+            }
+            if (highest - lowest < tolerance) {
+                return 0.5 * (highest + lowest);
+            }
+        }
+        throw std::logic_error("Markov chain policy evaluation didn't converge");
+    }
+
+    // readable binned state, see ChainPolicy::Row
+    std::string describeState(const ChainState& state, const ChainModel& model) {
+        std::string description;
+        for (size_t index = 0; index < model.entityCount; index++) {
+            const ChainEntity& entity = state.entities[index];
+            if (isIdle(entity)) {
+                continue;
+            }
+            if (!description.empty()) {
+                description += ' ';
+            }
+            description += getSide(model, (int)index) ? 'E' : 'F';
+            description += std::to_string(entity[stacksByte]);
+            if (entity[stacksByte] > 0) {
+                description += 'r' + std::to_string(entity[remainingByte]);
+            }
+            for (size_t bin = 0; bin < model.propagationTravelBins.size(); bin++) {
+                if (entity[incomingByte + bin] > 0) {
+                    description += '+' + std::to_string(entity[incomingByte + bin]) + '@' + std::to_string(bin);
+                }
+            }
+        }
+        return description;
+    }
+
+    // the model of a policy with empty travel probabilities, enough to encode and decode its states
+    ChainModel getKeyModel(size_t friendlyCount, size_t enemyCount, size_t travelBinCount) {
+        ChainModel model;
+        model.friendlyCount = friendlyCount;
+        model.entityCount = friendlyCount + enemyCount;
+        model.propagationTravelBins.resize(travelBinCount, 0.0);
+        return model;
+    }
+}
+
+int ChainPolicy::findTargetClass(const CastObservation& observation) const {
+    const ChainModel model = getKeyModel(friendlyCount, enemyCount, travelBinCount);
+    if (observation.stacks.size() < model.entityCount) {
+        return -1;
+    }
+    // the cast is at the start of its bin: stacks that run out within binWidth expire in this bin (0) and swarms
+    // that arrive within binWidth arrive in it
+    ChainState state;
+    for (size_t index = 0; index < model.entityCount; index++) {
+        if (observation.stacks[index] > 0) {
+            state.entities[index][stacksByte] = (uint8_t)observation.stacks[index];
+            int remaining = (int)std::floor(observation.remaining[index] / binWidth);
+            state.entities[index][remainingByte] = (uint8_t)std::clamp(remaining, 0, durationBins - 1);
+        }
+    }
+    for (const ObservedSwarm& swarm : observation.swarms) {
+        if (swarm.targetIndex < 0 || swarm.targetIndex >= (int)model.entityCount) {
+            continue;
+        }
+        int bin = std::clamp((int)std::floor(swarm.timeToArrival / binWidth), 0, (int)travelBinCount - 1);
+        uint8_t& incoming = state.entities[swarm.targetIndex][incomingByte + bin];
+        incoming = (uint8_t)std::min(incoming + swarm.stacks, 5);
+    }
+    return findTargetClass(encodeState(state, model));
+}
+
+int ChainPolicy::findTargetClass(const std::string& key) const {
+    auto action = actions.find(key);
+    return action == actions.end() ? -1 : action->second;
+}
+
+std::vector<ChainPolicy::Row> ChainPolicy::getRows() const {
+    const ChainModel model = getKeyModel(friendlyCount, enemyCount, travelBinCount);
+    std::vector<const std::pair<const std::string, uint8_t>*> entries;
+    for (const auto& entry : actions) {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](auto a, auto b) {
+        return a->first < b->first;
+    });
+    std::vector<Row> rows;
+    for (auto entry : entries) {
+        ChainState state = decodeState(entry->first, model);
+        Row& row = rows.emplace_back();
+        for (size_t index = 0; index < model.entityCount; index++) {
+            row.counts[getSide(model, (int)index) * 6 + state.entities[index][stacksByte]]++;
+        }
+        row.description = describeState(state, model);
+        row.targetClass = entry->second;
+    }
+    return rows;
+}
+
+std::vector<double> getTravelBinProbabilities(const SimParameters& parameters, bool isPropagated) {
+    const double width = parameters.chainBinWidth;
+    const double maxTravel = parameters.g_maxTraveltime;
+    // share of the uniform travel times in [0, g_maxTraveltime] that fall into [low, high)
+    auto getTravelShare = [&](double low, double high) {
+        if (maxTravel <= 0.0) {
+            return low <= 0.0 && high > 0.0 ? 1.0 : 0.0;
+        }
+        return std::max(0.0, std::min(high, maxTravel) - std::max(low, 0.0)) / maxTravel;
+    };
+    // a propagated swarm leaves at a uniform time in its bin, the share is linear in that time between the bin edges,
+    // so the midpoint rule over the departure times is exact up to rounding
+    const int departures = isPropagated ? 1024 : 1;
+    std::vector<double> probabilities;
+    for (size_t bin = 0; bin * width < maxTravel + width; bin++) {
+        double probability = 0.0;
+        for (int departure = 0; departure < departures; departure++) {
+            double start = isPropagated ? (departure + 0.5) / departures * width : 0.0;
+            probability += getTravelShare(bin * width - start, (bin + 1) * width - start) / departures;
+        }
+        probabilities.push_back(probability);
+    }
+    return probabilities;
+}
+
+ChainResult evaluateMarkovChain(size_t friendlyCount, size_t enemyCount, const TargetStrategy strategy, const SimParameters& parameters, size_t maxStates) {
+    ChainModel model = makeChainModel(friendlyCount, enemyCount, parameters);
+    ChainResult result;
+    visitTargetPolicy(strategy, [&](auto policy) {
+        typedef decltype(policy) Policy;
+        std::vector<ClassProbabilities> castClasses;
+        if constexpr (IsFocusTarget<Policy>::value) {
+            model.pinned = std::is_same_v<Policy, FocusTarget<EntitySide::FRIENDLY>> ? 0 : (int)friendlyCount;
+        }
+        ChainGraph graph = buildChainGraph(model, maxStates);
+        if constexpr (!IsFocusTarget<Policy>::value) {
+            castClasses = getCastClasses<Policy>(graph, model, enemyCount);
+        }
+        // a CHAIN table has its classes per chain state, the states it doesn't have (another bin width) keep the base strategy
+        if constexpr (std::is_same_v<Policy, TableTarget>) {
+            if (policyTable && policyTable->chainPolicy && !policyTable->usesBase) {
+                for (size_t i = 0; i < graph.castKeys.size(); i++) {
+                    int targetClass = policyTable->chainPolicy->findTargetClass(graph.castKeys[i]);
+                    if (targetClass >= 0) {
+                        castClasses[i].assign(1, { targetClass, 1.0 });
+                    }
+                }
+            }
+        }
+        result = iterateChain(graph, castClasses, model, parameters.chainTolerance);
+    });
+    return result;
+}
+
+std::shared_ptr<const ChainPolicy> solveChainPolicy(size_t friendlyCount, size_t enemyCount, TargetStrategy baseStrategy, const SimParameters& parameters, size_t maxStates) {
+    const ChainModel model = makeChainModel(friendlyCount, enemyCount, parameters);
+    const ChainGraph graph = buildChainGraph(model, maxStates);
+    std::vector<ClassProbabilities> castClasses;
+    visitTargetPolicy(baseStrategy, [&](auto policy) {
+        typedef decltype(policy) Policy;
+        if constexpr (std::is_same_v<Policy, TableTarget>) {
+            throw std::invalid_argument("the chain policy has to start from a hand written strategy");
+        }
+        else {
+            // FOCUS strategies become the class of their entity in the first cast state of the side, a start like any other
+            castClasses = getCastClasses<Policy>(graph, model, enemyCount);
+        }
+    });
+
+    auto policy = std::make_shared<ChainPolicy>();
+    policy->friendlyCount = friendlyCount;
+    policy->enemyCount = enemyCount;
+    policy->binWidth = parameters.chainBinWidth;
+    policy->durationBins = model.durationBins;
+    policy->travelBinCount = model.propagationTravelBins.size();
+    policy->stateCount = graph.friendlyActive.size();
+
+    // a class replaces the current one only if it's better by more than the evaluation can resolve, so the iteration ends
+    const double margin = std::max(1e-8, 10 * parameters.chainTolerance);
+    const int maxIterations = 100;
+    const std::vector<uint32_t>& castStates = graph.phaseStates[0];
+    std::vector<double> values(graph.friendlyActive.size(), 0.0);
+    double gain = 0.0;
+    for (int iteration = 1; iteration <= maxIterations; iteration++) {
+        gain = evaluateChainPolicy(graph, castClasses, model, parameters.chainTolerance, values);
+        if (iteration == 1) {
+            policy->baseTicksPerSecond = gain / model.castPeriod;
+        }
+        policy->iterations = iteration;
+        bool changed = false;
+        for (size_t i = 0; i < castStates.size(); i++) {
+            const uint32_t id = castStates[i];
+            double current = 0.0;
+            for (auto& targetClass : castClasses[i]) {
+                current += targetClass.second * getRowValue(graph, id, findClassRow(graph, id, targetClass.first), values);
+            }
+            // a mixed start (random fallbacks) always becomes its best class, which is at least as good as the mix
+            int best = -1;
+            double bestValue = castClasses[i].size() > 1 ? std::numeric_limits<double>::lowest() : current + margin;
+            for (size_t row = graph.rowStart[id]; row < graph.rowStart[id + 1]; row++) {
+                double value = getRowValue(graph, id, row, values);
+                if (value > bestValue) {
+                    best = graph.rowClass[row];
+                    bestValue = value;
+                }
+            }
+            if (best >= 0) {
+                castClasses[i].assign(1, { best, 1.0 });
+                changed = true;
+            }
+        }
+        if (!changed) {
+            break;
+        }
+    }
+    policy->ticksPerSecond = gain / model.castPeriod;
+
+    for (size_t i = 0; i < castStates.size(); i++) {
+        policy->actions.emplace(graph.castKeys[i], (uint8_t)castClasses[i].front().first);
+    }
+    return policy;
+}
+
+bool runChainSweepTask(const SweepGrid& grid, size_t taskIndex, SimResult& r, const SimParameters& parameters) {
+    SweepConfig config = getSweepConfig(grid, taskIndex);
+    if (config.friendlyCount > maxChainSideEntities || config.enemyCount > maxChainSideEntities) {
+        return false;
+    }
+    SimParameters chainParameters = parameters;
+    chainParameters.hasCircle = config.hasCircle;
+    ChainResult chain;
+    try {
+        chain = evaluateMarkovChain(config.friendlyCount, config.enemyCount, static_cast<TargetStrategy>(config.strategyIndex), chainParameters, (size_t)parameters.chainMaxStates);
+    }
+    catch (const std::logic_error&) {
+        return false;
+    }
+
+    r.groupSize = (int)config.friendlyCount;
+    r.enemyCount = (int)config.enemyCount;
+    r.hasCircle = config.hasCircle;
+    setStratName(r, config.strategyIndex);
+    r.ticksPerSecond = (float)chain.ticksPerSecond;
+    r.enemyTicksPerSecond = (float)chain.enemyTicksPerSecond;
+    r.friendlyTicksPerSecond = (float)chain.friendlyTicksPerSecond;
+    // expected casts of a simTime sim with the stationary target shares
+    const double castCount = (double)parameters.simTime / parameters.g_cooldown;
+    for (int stacks = 0; stacks < 6; stacks++) {
+        r.friendlyCasts[stacks] = (int)std::lround(chain.targetShares[0][stacks] * castCount);
+        r.enemyCasts[stacks] = (int)std::lround(chain.targetShares[1][stacks] * castCount);
+    }
+    // chain results have no replicas and no confidence interval
+    r.replicas = 0;
+    return true;
+}
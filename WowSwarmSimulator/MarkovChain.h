@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+
+#include "WowSwarmSimulator.h"
+#include "OptimalPolicy.h"
+
+// evaluation of small configurations without noise: the swarms are a Markov chain over bins of chainBinWidth seconds
+// (independent of timeDelta) with the state (bins until the next cast, per entity its stacks, the bins until they run out and
+// the stacks of the swarms that arrive at it in each of the next bins). the entities of a side are interchangeable, so every side is
+// sorted and its idle entities are left out of the state. the reachable states are enumerated once from the empty state with the rules
+// of castSwarm, expireSwarm/propagateSwarm and advanceTime (split chance, propagation to a random entity without stacks of the other side,
+// the 5 stack cap, the circle duration factor) and the uniform travel times binned exactly.
+// within a bin the cast comes first (the cooldown is a whole number of bins) and the other events are at uniform times, so an expiration
+// and an arrival at the same entity are in either order with the same chance and the entities tick half of the bin they change in.
+// the transitions are stored as a sparse matrix with one row per target class (side and stacks) in the cast states, a strategy picks the class
+// from the stacks per side like castSwarm and the cast goes to a uniform entity of the class (FOCUS strategies keep their entity instead),
+// the sims pick the first entity of the class in scan order. the distribution is iterated one cooldown period at a time until it doesn't change
+// anymore (power iteration), the expected ticks of that period are the stationary ticks/s.
+// against 5e6 second sims with timeDelta = 0.01 the 1 second bins are within -0.2% to +0.4% in every 1v1 (65k to 135k states, below a second),
+// the error halves with half the bin width but the states grow about 20 times. the entities of a larger side multiply the states:
+// a 1v2 has 1.6 million states with a FOCUS strategy and more than 8 million with the others, so in practice only the 1v1 configurations fit.
+// configurations that exceed maxStates are left to the sims, the limit is checked while the states are enumerated
+// so a chain that doesn't fit costs about as much as one that just fits.
+// the chain also solves the OPTIMAL strategy where it fits: policy iteration over the target classes of the cast states (solveChainPolicy).
+
+constexpr size_t maxChainSideEntities = 5;
+
+struct ChainResult {
+    double ticksPerSecond = 0.0;
+    double enemyTicksPerSecond = 0.0;
+    double friendlyTicksPerSecond = 0.0;
+    // share of the casts per target side (0 = friendly) and stacks of the target before the cast
+    std::array<std::array<double, 6>, 2> targetShares{};
+    // reachable states of the chain and number of periods until the distribution converged
+    size_t stateCount = 0;
+    int periods = 0;
+};
+
+// target classes of the cast states of a chain, solved by solveChainPolicy
+class ChainPolicy {
+public:
+    struct Row {
+        // entities per side and stack count at the cast, see PolicyState
+        PolicyState counts{};
+        // the binned state, per entity with stacks or swarms on the way its side (F/E), stacks, r and the bins until the stacks run out,
+        // and +stacks@bin for every incoming swarm, entities separated by spaces
+        std::string description;
+        int targetClass = 0;
+    };
+
+    // stationary ticks per second of the policy in the chain, of the base strategy it started from and the rounds of policy iteration
+    double ticksPerSecond = 0.0;
+    double baseTicksPerSecond = 0.0;
+    size_t stateCount = 0;
+    int iterations = 0;
+
+    // target class (side * 6 + stacks) in the binned state of the observation, -1 if the chain never reaches that state
+    int findTargetClass(const CastObservation& observation) const;
+    // target class of a cast state of the chain by its key, -1 if the key isn't a cast state
+    int findTargetClass(const std::string& key) const;
+    // the cast states sorted by key
+    std::vector<Row> getRows() const;
+
+private:
+    friend std::shared_ptr<const ChainPolicy> solveChainPolicy(size_t, size_t, TargetStrategy, const SimParameters&, size_t);
+    // what it takes to bin an observation like the states of the chain
+    size_t friendlyCount = 0;
+    size_t enemyCount = 0;
+    float binWidth = 1.0f;
+    uint8_t durationBins = 0;
+    size_t travelBinCount = 0;
+    std::unordered_map<std::string, uint8_t> actions;
+};
+
+// probability that a swarm arrives 0, 1, ... bins of chainBinWidth after the bin it leaves in,
+// cast swarms leave at the start of the bin and propagated swarms at a uniform time in it
+std::vector<double> getTravelBinProbabilities(const SimParameters& parameters, bool isPropagated);
+// throws std::invalid_argument if the configuration is too large or the cooldown or duration isn't a whole number of bins,
+// std::logic_error if the chain has more than maxStates states
+ChainResult evaluateMarkovChain(size_t friendlyCount, size_t enemyCount, const TargetStrategy strategy, const SimParameters& parameters, size_t maxStates);
+// policy iteration on the chain of the configuration, starting from the target classes of baseStrategy (which has to be a hand written strategy).
+// throws like evaluateMarkovChain
+std::shared_ptr<const ChainPolicy> solveChainPolicy(size_t friendlyCount, size_t enemyCount, TargetStrategy baseStrategy, const SimParameters& parameters, size_t maxStates);
+// sweep task of the chain, the casts columns are the expected casts of a simTime sim with the stationary target shares.
+// returns false (and leaves r alone) if the chain can't evaluate the configuration
+// (too many entities or states, cooldown or duration not on the bin grid, bins too small).
+// OPTIMAL evaluates the table of the thread (policyTable): a CHAIN table with its own classes, any other table like castSwarm would
+bool runChainSweepTask(const SweepGrid& grid, size_t taskIndex, SimResult& r, const SimParameters& parameters);
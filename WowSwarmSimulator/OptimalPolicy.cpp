@@ -0,0 +1,315 @@
+#include "OptimalPolicy.h"
+#include "EventSimulator.h"
+#include "SwarmQueue.h"
+#include "TargetPolicies.h"
+#include "SimRng.h"
+#include "MarkovChain.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+thread_local const PolicyTable* policyTable = nullptr;
+thread_local const CastObservation* castObservation = nullptr;
+
+namespace {
+    // action = side * 6 + stacks
+    constexpr int policyActionCount = 12;
+    constexpr uint32_t policySampleReplica = 0x80000000u;
+    // comparisons a state needs before its action can change
+    constexpr int minComparisons = 8;
+
+    std::string getStateKey(const PolicyState& state) {
+        return std::string(state.begin(), state.end());
+    }
+
+    EntitySide getActionSide(int action) {
+        return action < 6 ? EntitySide::FRIENDLY : EntitySide::ENEMY;
+    }
+
+    // target picked by the sampler right before the cast
+    struct SampledTarget {
+        static constexpr bool hasFallback = false;
+        static constexpr bool isRandom = false;
+        static thread_local int index;
+
+        template<typename EntityContainer>
+        static int selectTarget(EntityContainer&) {
+            return index;
+        }
+    };
+    thread_local int SampledTarget::index = 0;
+
+    // everything the fixed step loop carries from one step to the next, copied for the rollouts
+    struct SampleRun {
+        EntityStore entities;
+        SwarmQueue swarms;
+        SwarmStats stats;
+        int64_t step = 1;
+        int64_t castCount = 1;
+    };
+
+    int64_t getTicks(const SwarmStats& stats) {
+        return (int64_t)stats.friendlyTicks + stats.enemyTicks;
+    }
+
+    // fixed step loop of runSwarmSim from run.step up to the cast castCount (excluded) with the table targets,
+    // except the first cast if firstAction isn't -1
+    void advanceRun(SampleRun& run, int64_t castCount, int firstAction, const SimParameters& parameters) {
+        const int64_t endStep = getCastStep(castCount, parameters);
+        for (; run.step < endStep; run.step++) {
+            if (run.step == getCastStep(run.castCount, parameters)) {
+                if (firstAction >= 0) {
+                    SampledTarget::index = findEntity(run.entities, firstAction % 6, getActionSide(firstAction), ScanOrder::ASCENDING);
+                    firstAction = -1;
+                }
+                else {
+                    SampledTarget::index = TableTarget::selectTarget(run.entities);
+                }
+                castSwarm<SampledTarget>(run.entities, run.swarms.launched, run.stats, parameters);
+                run.swarms.schedule(run.step, parameters);
+                run.castCount++;
+            }
+            advanceTime(run.entities, run.swarms, run.step, parameters);
+            recordSwarmStats(run.entities, run.stats);
+        }
+    }
+
+    // sum and sum of squares of the rollout ticks of an action relative to the mean of all actions of the same cast
+    struct ActionValue {
+        int count = 0;
+        double sum = 0.0;
+        double squares = 0.0;
+
+        double mean() const {
+            return sum / count;
+        }
+        double variance() const {
+            return count > 1 ? std::max(0.0, (squares - sum * sum / count) / (count - 1)) : 0.0;
+        }
+    };
+
+    struct StateValues {
+        PolicyState state;
+        // action of the current policy (the base strategy for states without an entry)
+        int greedy = 0;
+        int comparisons = 0;
+        std::array<ActionValue, policyActionCount> actions;
+    };
+
+    // compares all target classes at the cast from copies of the run with the same random numbers
+    void compareActions(const SampleRun& run, const PolicyState& state, const SimParameters& parameters, StateValues& values) {
+        const SimRng saved = rng;
+        std::array<double, policyActionCount> ticks{};
+        double mean = 0.0;
+        int available = 0;
+        for (int action = 0; action < policyActionCount; action++) {
+            if (state[action] == 0) {
+                continue;
+            }
+            rng = saved;
+            SampleRun rollout = run;
+            advanceRun(rollout, run.castCount + parameters.policyHorizon, action, parameters);
+            ticks[action] = (double)(getTicks(rollout.stats) - getTicks(run.stats));
+            mean += ticks[action];
+            available++;
+        }
+        rng = saved;
+        mean /= available;
+        EntityStore entities = run.entities;
+        int target = TableTarget::selectTarget(entities);
+        rng = saved;
+        values.greedy = (target >= (int)run.entities.g_size ? 6 : 0) + run.entities.stacks[target];
+        for (int action = 0; action < policyActionCount; action++) {
+            if (state[action] > 0) {
+                ActionValue& value = values.actions[action];
+                value.count++;
+                value.sum += ticks[action] - mean;
+                value.squares += (ticks[action] - mean) * (ticks[action] - mean);
+            }
+        }
+        values.comparisons++;
+    }
+
+    // the best hand written strategy of the configuration, the random ones can't be written as a table
+    TargetStrategy findBaseStrategy(size_t friendlyCount, size_t enemyCount, const SimParameters& parameters, uint64_t seed, uint32_t config) {
+        TargetStrategy best = TargetStrategy::LOWEST;
+        double bestTicks = -1.0;
+        for (TargetStrategy strategy : getAllStrategies()) {
+            bool isRandom = false;
+            visitTargetPolicy(strategy, [&](auto policy) {
+                isRandom = decltype(policy)::isRandom;
+            });
+            if (isRandom) {
+                continue;
+            }
+            seedSimRng(seed, config, policySampleReplica + (uint32_t)strategy);
+            SwarmStats stats = runSwarmSim(friendlyCount, enemyCount, strategy, parameters);
+            if ((double)getTicks(stats) > bestTicks) {
+                best = strategy;
+                bestTicks = (double)getTicks(stats);
+            }
+        }
+        return best;
+    }
+
+    // the ROLLOUTS solver (see OptimalPolicy.h), the table starts without entries
+    void solveByRollouts(PolicyTable& table, const SimParameters& sampleParameters, const SimParameters& parameters, uint64_t seed, uint32_t config) {
+        const size_t friendlyCount = table.friendlyCount;
+        const size_t enemyCount = table.enemyCount;
+        policyTable = &table;
+        std::unordered_map<std::string, StateValues> values;
+        const int64_t stepCount = getSimStepCount(sampleParameters);
+        for (int round = 0; round < parameters.policyRounds; round++) {
+            seedSimRng(seed, config, policySampleReplica + 0x100 + (uint32_t)round);
+            SampleRun run{ EntityStore{ friendlyCount, enemyCount }, SwarmQueue{}, SwarmStats{}, 1, 1 };
+            while (getCastStep(run.castCount, sampleParameters) <= stepCount) {
+                advanceRun(run, run.castCount, -1, sampleParameters);
+                if (rng.nextFloat() < parameters.policyRolloutChance) {
+                    PolicyState state = getPolicyState(run.entities);
+                    StateValues& stateValues = values[getStateKey(state)];
+                    stateValues.state = state;
+                    compareActions(run, state, sampleParameters, stateValues);
+                }
+                advanceRun(run, run.castCount + 1, -1, sampleParameters);
+            }
+            // the greedy run without the rollouts
+            double elapsed = (run.step - 1) * sampleParameters.timeDelta;
+            table.sampledTicksPerSecond = getTicks(run.stats) * sampleParameters.timeDelta / elapsed;
+
+            // an action replaces the current one only if it's better by more than twice the standard error of the difference
+            for (const auto& entry : values) {
+                const StateValues& stateValues = entry.second;
+                if (stateValues.comparisons < minComparisons) {
+                    continue;
+                }
+                int current = -1;
+                const PolicyAction* action = table.find(stateValues.state);
+                if (action) {
+                    current = (action->side == EntitySide::ENEMY ? 6 : 0) + action->stacks;
+                }
+                else {
+                    current = stateValues.greedy;
+                }
+                int best = current;
+                for (int a = 0; a < policyActionCount; a++) {
+                    const ActionValue& candidate = stateValues.actions[a];
+                    const ActionValue& incumbent = stateValues.actions[current];
+                    if (candidate.count < minComparisons || a == current) {
+                        continue;
+                    }
+                    double error = std::sqrt(candidate.variance() / candidate.count + incumbent.variance() / incumbent.count);
+                    if (candidate.mean() - incumbent.mean() > 2 * error && candidate.mean() > stateValues.actions[best].mean()) {
+                        best = a;
+                    }
+                }
+                table.actions[entry.first] = { getActionSide(best), best % 6, stateValues.comparisons };
+            }
+        }
+    }
+
+    double getTicksPerSecond(const SwarmStats& stats, const SimParameters& parameters) {
+        return getTicks(stats) * parameters.timeDelta / parameters.simTime;
+    }
+
+    // the finished table against its base strategy in the sim of the sweep, both on the rng stream of the same replica
+    void compareWithBase(PolicyTable& table, const SimParameters& parameters, uint64_t seed, uint32_t config) {
+        SimParameters compareParameters = parameters;
+        compareParameters.simTime = parameters.policySampleTime;
+        policyTable = &table;
+        seedSimRng(seed, config, policySampleReplica + 0x200);
+        table.tableTicksPerSecond = getTicksPerSecond(runSwarmSim(table.friendlyCount, table.enemyCount, TargetStrategy::OPTIMAL, compareParameters), compareParameters);
+        seedSimRng(seed, config, policySampleReplica + 0x200);
+        table.baseTicksPerSecond = getTicksPerSecond(runSwarmSim(table.friendlyCount, table.enemyCount, table.baseStrategy, compareParameters), compareParameters);
+        table.usesBase = !(table.tableTicksPerSecond > table.baseTicksPerSecond);
+    }
+}
+
+const PolicyAction* PolicyTable::find(const PolicyState& state) const {
+    auto action = actions.find(getStateKey(state));
+    return action == actions.end() ? nullptr : &action->second;
+}
+
+PolicyTable solveOptimalPolicy(size_t friendlyCount, size_t enemyCount, const SimParameters& parameters, uint64_t seed, uint32_t config) {
+    SimParameters sampleParameters = parameters;
+    sampleParameters.timeDelta = parameters.policyTimeDelta;
+    sampleParameters.simTime = parameters.policySampleTime;
+    if (getCastStep(1, sampleParameters) < 1) {
+        throw std::invalid_argument("the cooldown has to be at least one time step");
+    }
+    if (parameters.policyHorizon < 1) {
+        throw std::invalid_argument("the policy horizon has to be at least one cast");
+    }
+
+    PolicyTable table;
+    table.friendlyCount = friendlyCount;
+    table.enemyCount = enemyCount;
+    table.hasCircle = parameters.hasCircle;
+    // the base is picked with the time step of the samples, the table refines it under the same sim
+    table.baseStrategy = findBaseStrategy(friendlyCount, enemyCount, sampleParameters, seed, config);
+
+    const PolicyTable* previousTable = policyTable;
+    // a chain that doesn't fit or isn't on the bin grid leaves the table to the rollouts
+    try {
+        table.chainPolicy = solveChainPolicy(friendlyCount, enemyCount, table.baseStrategy, parameters, (size_t)parameters.chainMaxStates);
+        table.solver = PolicySolver::CHAIN;
+        table.sampledTicksPerSecond = table.chainPolicy->ticksPerSecond;
+    }
+    catch (const std::logic_error&) {
+        solveByRollouts(table, sampleParameters, parameters, seed, config);
+    }
+    compareWithBase(table, parameters, seed, config);
+    policyTable = previousTable;
+    return table;
+}
+
+PolicyTableWriter::PolicyTableWriter(const std::string& path) {
+    outFile.open(path);
+    if (!outFile) {
+        throw std::invalid_argument("can't create policy table file " + path);
+    }
+    outFile <<
+        "group_size;enemyCount;hasCircle;baseStrategy;solver;approximate;usesBase;"
+        "friendlies0;friendlies1;friendlies2;friendlies3;friendlies4;friendlies5;"
+        "enemies0;enemies1;enemies2;enemies3;enemies4;enemies5;chainState;"
+        "targetSide;targetStacks;comparisons;sampledTicksPerSecond;tableTicksPerSecond;baseTicksPerSecond\n";
+    outFile.flush();
+}
+
+// rows sorted by state, so the file only depends on the seed.
+// ROLLOUTS tables are approximate and have no chainState, CHAIN tables have one row per chain state and no comparisons
+void PolicyTableWriter::write(const PolicyTable& table) {
+    auto writeRow = [&](const PolicyState& counts, const std::string& chainState, int targetClass, int comparisons) {
+        outFile << table.friendlyCount << ";" << table.enemyCount << ";" << (table.hasCircle ? 1 : 0) << ";";
+        outFile << stratNames[(size_t)table.baseStrategy] << ";";
+        outFile << (table.solver == PolicySolver::CHAIN ? "CHAIN;0;" : "ROLLOUTS;1;") << (table.usesBase ? 1 : 0) << ";";
+        for (uint8_t count : counts) {
+            outFile << (int)count << ";";
+        }
+        outFile << chainState << ";";
+        outFile << (getActionSide(targetClass) == EntitySide::ENEMY ? "ENEMY" : "FRIENDLY") << ";" << targetClass % 6 << ";";
+        outFile << comparisons << ";" << table.sampledTicksPerSecond << ";" << table.tableTicksPerSecond << ";" << table.baseTicksPerSecond << "\n";
+    };
+    if (table.chainPolicy) {
+        for (const ChainPolicy::Row& row : table.chainPolicy->getRows()) {
+            writeRow(row.counts, row.description, row.targetClass, 0);
+        }
+    }
+    std::vector<const std::pair<const std::string, PolicyAction>*> rows;
+    for (const auto& row : table.actions) {
+        rows.push_back(&row);
+    }
+    std::sort(rows.begin(), rows.end(), [](auto a, auto b) {
+        return a->first < b->first;
+    });
+    for (auto row : rows) {
+        PolicyState counts;
+        std::copy(row->first.begin(), row->first.end(), counts.begin());
+        writeRow(counts, "", (row->second.side == EntitySide::ENEMY ? 6 : 0) + row->second.stacks, row->second.visits);
+    }
+    outFile.flush();
+    if (!outFile) {
+        throw std::runtime_error("can't write to the policy table file");
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <unordered_map>
+#include <cstdint>
+
+#include "WowSwarmSimulator.h"
+#include "EntityStore.h"
+
+// optimal cast targets of a configuration as a lookup table, solved one of two ways (PolicySolver):
+// CHAIN: if the Markov chain of the configuration fits into chainMaxStates (see MarkovChain.h, in practice the 1v1 configurations),
+// the table is solved by policy iteration on the chain (average reward, the gain of the policy is evaluated exactly by relative value
+// iteration and every cast state switches to the target class with the best value until no state changes). the state of such a table is the
+// whole binned chain state (stacks, bins until the stacks run out and the swarms on their way), the sims describe it at every cast
+// (CastObservation). the result is optimal for the binned chain, which is within a few tenths of a percent of the sims:
+// with the defaults the 1v1 tables reach 1.307 ticks/s (1.200 with the circle) in 1e6 second sims, the best hand written strategies 1.269 (1.118).
+// ROLLOUTS: everywhere else the table is an approximation. the state at a cast is abstracted to the number of entities per side and
+// stack count (which entity has them doesn't matter, durations and traveling swarms are left out), an action is the side and stack count
+// of the target (any entity of that class, all strategies pick targets like that). the table starts as the best hand written strategy of the
+// configuration (baseStrategy, the random ones can't be a table) and every round runs the fixed step loop for policySampleTime seconds with
+// policyTimeDelta under the current table. at policyRolloutChance of the casts every available target class is tried on a copy of the run
+// with the same random numbers for the next policyHorizon casts, the comparisons of all rounds are averaged per state and a class replaces
+// the current one only if it's better by more than twice the standard error of the difference. the abstraction hides the durations, so
+// this is a heuristic improvement and not policy iteration, it can end up worse than the strategy it started from.
+// either way the finished table is run against baseStrategy with common random numbers (the same rng stream for both) for policySampleTime
+// seconds of the sweep's own sim, and if the table doesn't beat it the table is kept for the output but OPTIMAL casts like baseStrategy (usesBase).
+
+// target of a cast: an entity of the side (FRIENDLY or ENEMY) with the given stacks
+struct PolicyAction {
+    EntitySide side = EntitySide::ENEMY;
+    int stacks = 0;
+    // casts in the state in the last round of the solver
+    int visits = 0;
+};
+
+// entities per side and stack count, [side * 6 + stacks] with the group as side 0
+typedef std::array<uint8_t, 12> PolicyState;
+
+enum class PolicySolver {
+    CHAIN, ROLLOUTS
+};
+
+class ChainPolicy;
+
+struct ObservedSwarm {
+    int targetIndex = 0;
+    int stacks = 0;
+    float timeToArrival = 0.0f;
+};
+
+// what a CHAIN table needs to know at a cast besides the stacks, filled by the sims right before they cast with such a table
+struct CastObservation {
+    std::vector<int> stacks;
+    // seconds until the stacks of the entity run out, 0 without stacks
+    std::vector<float> remaining;
+    std::vector<ObservedSwarm> swarms;
+};
+
+struct PolicyTable {
+    size_t friendlyCount = 0;
+    size_t enemyCount = 0;
+    bool hasCircle = false;
+    // strategy of the states without an entry
+    TargetStrategy baseStrategy = TargetStrategy::LOWEST;
+    PolicySolver solver = PolicySolver::ROLLOUTS;
+    // ROLLOUTS: average ticks per second of the last round of the solver (with the exploration casts),
+    // CHAIN: stationary ticks per second of the policy in the chain
+    double sampledTicksPerSecond = 0.0;
+    // ticks per second of the table and of baseStrategy in the comparison with common random numbers
+    double tableTicksPerSecond = 0.0;
+    double baseTicksPerSecond = 0.0;
+    // the table lost the comparison, OPTIMAL casts like baseStrategy
+    bool usesBase = false;
+    // ROLLOUTS: entries per PolicyState
+    std::unordered_map<std::string, PolicyAction> actions;
+    // CHAIN: target classes per chain state
+    std::shared_ptr<const ChainPolicy> chainPolicy;
+
+    // nullptr if the state has no entry
+    const PolicyAction* find(const PolicyState& state) const;
+};
+
+// table of the OPTIMAL strategy in the sims of the calling thread (set by the sweep for the configuration of its task)
+extern thread_local const PolicyTable* policyTable;
+// state of the cast in progress for CHAIN tables, nullptr outside of a cast
+extern thread_local const CastObservation* castObservation;
+
+template<typename EntityContainer>
+PolicyState getPolicyState(EntityContainer& entities) {
+    PolicyState state;
+    for (int stacks = 0; stacks < 6; stacks++) {
+        state[stacks] = (uint8_t)countEntities(entities, stacks, EntitySide::FRIENDLY);
+        state[6 + stacks] = (uint8_t)countEntities(entities, stacks, EntitySide::ENEMY);
+    }
+    return state;
+}
+
+// the samples and the comparison with the base strategy use the rng streams (seed, config, replica) with replicas from 0x80000000 on,
+// so they don't overlap the sims of the sweep
+PolicyTable solveOptimalPolicy(size_t friendlyCount, size_t enemyCount, const SimParameters& parameters, uint64_t seed, uint32_t config);
+
+// semicolon separated lookup tables, one row per configuration and state (chain state for CHAIN tables), written and flushed per table
+class PolicyTableWriter {
+public:
+    // throws std::invalid_argument if the file can't be created
+    PolicyTableWriter(const std::string& path);
+    void write(const PolicyTable& table);
+
+private:
+    std::ofstream outFile;
+};
@@ -0,0 +1,112 @@
+#include "Replication.h"
+#include "LaneSimulator.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+void RunningStat::add(double value) {
+    count++;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+}
+
+double RunningStat::getVariance() const {
+    return count > 1 ? m2 / (count - 1) : 0.0;
+}
+
+// half width of the 95% confidence interval of the mean
+double RunningStat::getHalfWidth95() const {
+    if (count < 2) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return getStudentT95(count - 1) * std::sqrt(getVariance() / count);
+}
+
+// two sided 95% quantile of the student t distribution, tabulated up to 30 degrees of freedom and approximated above
+double getStudentT95(int degreesOfFreedom) {
+    constexpr std::array<double, 30> quantiles{
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (degreesOfFreedom < 1) {
+        throw std::invalid_argument("degrees of freedom have to be at least 1");
+    }
+    if (degreesOfFreedom <= quantiles.size()) {
+        return quantiles[degreesOfFreedom - 1];
+    }
+    return 1.96 + 2.4 / degreesOfFreedom;
+}
+
+// runs independent replicas of a sweep configuration (replica r uses the rng stream (seed, task, r)) until the confidence interval
+// of ticks/s is narrow enough, so noisy configurations get more replicas than easy ones
+void runReplicatedSweepTask(const SweepGrid& grid, size_t taskIndex, SimResult& r, const SimParameters& parameters) {
+    if (parameters.replicaTime <= 0 || parameters.warmupTime < 0) {
+        throw std::invalid_argument("replica time has to be positive and warmup time can't be negative");
+    }
+    SweepConfig config = getSweepConfig(grid, taskIndex);
+    SimParameters replicaParameters = parameters;
+    replicaParameters.hasCircle = config.hasCircle;
+    replicaParameters.simTime = parameters.warmupTime + parameters.replicaTime;
+    const TargetStrategy strategy = static_cast<TargetStrategy>(config.strategyIndex);
+    const int minReplicas = std::max(2, parameters.minReplicas);
+    const int maxReplicas = std::max(minReplicas, parameters.maxReplicas);
+
+    RunningStat ticks;
+    RunningStat enemyTicks;
+    RunningStat friendlyTicks;
+    std::array<std::array<int, 6>, 2> targetCasts{ 0 };
+    // adds a replica, returns true once the confidence interval is narrow enough
+    auto addReplica = [&](const SwarmStats& stats) {
+        double enemyRate = stats.enemyTicks * replicaParameters.timeDelta / stats.simTime;
+        double friendlyRate = stats.friendlyTicks * replicaParameters.timeDelta / stats.simTime;
+        ticks.add(enemyRate + friendlyRate);
+        enemyTicks.add(enemyRate);
+        friendlyTicks.add(friendlyRate);
+        for (int side = 0; side < 2; side++) {
+            for (int stacks = 0; stacks < 6; stacks++) {
+                targetCasts[side][stacks] += stats.targetCasts[side][stacks];
+            }
+        }
+
+        return ticks.count >= minReplicas && ticks.getHalfWidth95() <= parameters.ciRelativeHalfWidth * ticks.mean;
+    };
+    // lanes past the stopping replica are simulated but not used, so both ways stop at the same replica.
+    // the lanes run the fixed step loop, event driven replicas are simulated one after another
+    if (parameters.laneReplicas && !parameters.eventDriven) {
+        bool done = false;
+        for (int firstReplica = 0; firstReplica < maxReplicas && !done; firstReplica += simLaneCount) {
+            LaneStats laneStats;
+            runSwarmSimLanes(config.friendlyCount, config.enemyCount, strategy, replicaParameters, parameters.warmupTime,
+                static_cast<uint64_t>(parameters.seed), static_cast<uint32_t>(taskIndex), static_cast<uint32_t>(firstReplica), laneStats);
+            for (int lane = 0; lane < simLaneCount && firstReplica + lane < maxReplicas && !done; lane++) {
+                done = addReplica(laneStats[lane]);
+            }
+        }
+    }
+    else {
+        for (int replica = 0; replica < maxReplicas; replica++) {
+            seedSimRng(static_cast<uint64_t>(parameters.seed), static_cast<uint32_t>(taskIndex), static_cast<uint32_t>(replica));
+            if (addReplica(runSwarmSim(config.friendlyCount, config.enemyCount, strategy, replicaParameters, parameters.warmupTime))) {
+                break;
+            }
+        }
+    }
+
+    r.groupSize = (int)config.friendlyCount;
+    r.enemyCount = (int)config.enemyCount;
+    r.hasCircle = config.hasCircle;
+    setStratName(r, config.strategyIndex);
+    r.ticksPerSecond = (float)ticks.mean;
+    r.enemyTicksPerSecond = (float)enemyTicks.mean;
+    r.friendlyTicksPerSecond = (float)friendlyTicks.mean;
+    // casts are summed over all replicas (incl. warmup)
+    r.friendlyCasts = targetCasts[0];
+    r.enemyCasts = targetCasts[1];
+    r.replicas = ticks.count;
+    r.ticksPerSecondCI = (float)ticks.getHalfWidth95();
+    r.enemyTicksPerSecondCI = (float)enemyTicks.getHalfWidth95();
+    r.friendlyTicksPerSecondCI = (float)friendlyTicks.getHalfWidth95();
+}
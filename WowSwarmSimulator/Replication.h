@@ -0,0 +1,17 @@
+#pragma once
+
+#include "WowSwarmSimulator.h"
+
+// running mean and variance of a sample (Welford), no samples are stored
+struct RunningStat {
+    int count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+
+    void add(double value);
+    double getVariance() const;
+    double getHalfWidth95() const;
+};
+
+double getStudentT95(int degreesOfFreedom);
+void runReplicatedSweepTask(const SweepGrid& grid, size_t taskIndex, SimResult& r, const SimParameters& parameters);
@@ -1,6 +1,8 @@
 #include "SimControllerRenderer.h"
 
 #include <thread>
+#include <string>
+#include <exception>
 
 #include "imgui.h"
 #include "imgui_internal.h"
@@ -47,6 +49,10 @@ void renderControllerWindow(SimParameters& parameters, SimData& simData) {
 	{
 		for (int n = 0; n < stratNames.size(); n++)
 		{
+			// the realtime sim has no solved table, OPTIMAL would silently play LOWEST
+			if (static_cast<TargetStrategy>(n) == TargetStrategy::OPTIMAL) {
+				continue;
+			}
 			const bool is_selected = (strategyComboPreviewValue == stratNames[n]);
 			if (ImGui::Selectable(stratNames[n].data(), is_selected)) {
 				parameters.strategy = static_cast<TargetStrategy>(n);
@@ -90,8 +96,40 @@ void renderControllerWindow(SimParameters& parameters, SimData& simData) {
 		simData.isRunning = false;
 	}
 
+	ImGui::Checkbox("Event driven", &parameters.eventDriven);
+	ImGui::InputInt("Seed", &parameters.seed);
+	ImGui::SliderInt("Threads (0 = all cores)", &parameters.threadCount, 0, 64);
+	ImGui::Checkbox("Adaptive replication", &parameters.replicate);
+	if (parameters.replicate) {
+		ImGui::SliderFloat("Replica duration", &parameters.replicaTime, 10.0f, 10000.0f);
+		ImGui::SliderFloat("Warmup duration", &parameters.warmupTime, 0.0f, 1000.0f);
+		ImGui::SliderFloat("Target CI half width (relative)", &parameters.ciRelativeHalfWidth, 0.001f, 0.2f, "%.3f");
+		ImGui::SliderInt("Min replicas", &parameters.minReplicas, 2, 100);
+		ImGui::SliderInt("Max replicas", &parameters.maxReplicas, 2, 1000);
+		ImGui::Checkbox("SIMD lane replicas", &parameters.laneReplicas);
+	}
+	ImGui::Checkbox("Markov chain for small configurations (1v1 with the defaults)", &parameters.exactChain);
+	if (parameters.exactChain) {
+		ImGui::InputInt("Chain max states", &parameters.chainMaxStates);
+		ImGui::InputFloat("Chain bin width", &parameters.chainBinWidth);
+	}
+	ImGui::InputText("Results file", &parameters.resultsPath);
+	bool binaryResults = parameters.resultsFormat == ResultsFormat::BINARY;
+	if (ImGui::Checkbox("Binary results", &binaryResults)) {
+		parameters.resultsFormat = binaryResults ? ResultsFormat::BINARY : ResultsFormat::CSV;
+	}
+	static std::string sweepError;
 	if (ImGui::Button("Run all combinations")) {
-		RunSim(parameters);
+		sweepError.clear();
+		try {
+			RunSim(parameters);
+		}
+		catch (const std::exception& e) {
+			sweepError = e.what();
+		}
+	}
+	if (!sweepError.empty()) {
+		ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", sweepError.c_str());
 	}
 
 	ImGui::End();
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// counter based random numbers for the simulators (Philox4x32-10):
+// a block of 4 random words is a pure function of (key, counter), the key is the seed
+// and the counter holds the block index in the lower two words and the stream (config, replica) in the upper two.
+// so every (seed, config, replica) is an independent stream that can be created anywhere without any setup or shared state,
+// e.g. one per sweep task and replica on any thread, and the same stream always gives the same numbers.
+
+constexpr uint32_t philoxM0 = 0xD2511F53;
+constexpr uint32_t philoxM1 = 0xCD9E8D57;
+constexpr uint32_t philoxW0 = 0x9E3779B9;
+constexpr uint32_t philoxW1 = 0xBB67AE85;
+
+inline std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key) {
+    for (int round = 0; round < 10; round++) {
+        uint64_t product0 = (uint64_t)philoxM0 * counter[0];
+        uint64_t product1 = (uint64_t)philoxM1 * counter[2];
+        counter = {
+            (uint32_t)(product1 >> 32) ^ counter[1] ^ key[0],
+            (uint32_t)product1,
+            (uint32_t)(product0 >> 32) ^ counter[3] ^ key[1],
+            (uint32_t)product0
+        };
+        key[0] += philoxW0;
+        key[1] += philoxW1;
+    }
+    return counter;
+}
+
+class SimRng {
+public:
+    SimRng(uint64_t seed = 0, uint32_t config = 0, uint32_t replica = 0) {
+        key = { (uint32_t)seed, (uint32_t)(seed >> 32) };
+        counter = { 0, 0, config, replica };
+    }
+
+    // independent stream of the same seed
+    SimRng split(uint32_t config, uint32_t replica) const {
+        SimRng other;
+        other.key = key;
+        other.counter = { 0, 0, config, replica };
+        return other;
+    }
+
+    uint32_t next() {
+        if (bufferIndex == 4) {
+            buffer = philox4x32(counter, key);
+            bufferIndex = 0;
+            if (++counter[0] == 0) {
+                counter[1]++;
+            }
+        }
+        return buffer[bufferIndex++];
+    }
+
+    // uniform in [0, bound) without modulo bias (multiply and reject, only bound / 2^32 of the draws are redrawn)
+    uint32_t nextBounded(uint32_t bound) {
+        uint64_t product = (uint64_t)next() * bound;
+        uint32_t low = (uint32_t)product;
+        if (low < bound) {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                product = (uint64_t)next() * bound;
+                low = (uint32_t)product;
+            }
+        }
+        return (uint32_t)(product >> 32);
+    }
+
+    // uniform in [low, high]
+    int nextInt(int low, int high) {
+        return low + (int)nextBounded((uint32_t)(high - low) + 1);
+    }
+
+    // uniform in [0, 1) with 24 random bits (every representable multiple of 2^-24)
+    float nextFloat() {
+        return (next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // uniform in [0, high), the product can round up to high
+    float nextFloat(float high) {
+        return nextFloat() * high;
+    }
+
+private:
+    std::array<uint32_t, 2> key{ 0 };
+    std::array<uint32_t, 4> counter{ 0 };
+    std::array<uint32_t, 4> buffer{ 0 };
+    int bufferIndex = 4;
+};
+
+// generator of the calling thread, used by all sims (see seedSimRng)
+extern thread_local SimRng rng;
@@ -0,0 +1,38 @@
+#include "WowSwarmSimulator.h"
+#include "SweepJob.h"
+#include "SweepOutput.h"
+
+#include <iostream>
+#include <exception>
+
+// headless sweep runner (no GUI, builds on Linux with the Makefile):
+// usage: swarmsim <config file> [results file]
+// the results file argument overrides resultsPath of the config, progress goes to stderr
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: " << argv[0] << " <config file> [results file]\n";
+        return 2;
+    }
+    try {
+        SweepJob job = readSweepJob(std::string(argv[1]));
+        if (argc == 3) {
+            job.parameters.resultsPath = argv[2];
+        }
+
+        SweepWriter writer{ job.parameters.resultsPath, job.parameters.resultsFormat };
+        const size_t taskCount = job.grid.getTaskCount();
+        size_t doneCount = 0;
+        runSweep(job.grid, job.parameters, [&](size_t, const SimResult& result) {
+            writer.write(result);
+            doneCount++;
+            std::cerr << doneCount << "/" << taskCount << " " << result.groupSize << " friends, " << result.enemyCount << " enemies, "
+                << (result.hasCircle ? "circle, " : "") << result.stratName << ": " << result.ticksPerSecond << " ticks/s\n";
+        });
+    }
+    catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
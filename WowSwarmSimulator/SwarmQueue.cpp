@@ -0,0 +1,54 @@
+#include "SwarmQueue.h"
+#include "EventSimulator.h"
+
+#include <algorithm>
+
+namespace {
+    // std heaps keep the largest element on top
+    bool arrivesLater(const QueuedSwarm& a, const QueuedSwarm& b) {
+        return a.arrivalStep > b.arrivalStep;
+    }
+}
+
+void SwarmQueue::schedule(int64_t firstTravelStep, const SimParameters& parameters) {
+    for (auto& swarm : launched) {
+        heap.push_back({ firstTravelStep + getTravelSteps(swarm.travelTime, parameters), swarm.sourceIndex, swarm.targetIndex, swarm.stacks });
+        std::push_heap(heap.begin(), heap.end(), arrivesLater);
+    }
+    launched.clear();
+}
+
+QueuedSwarm SwarmQueue::popArrival() {
+    std::pop_heap(heap.begin(), heap.end(), arrivesLater);
+    QueuedSwarm swarm = heap.back();
+    heap.pop_back();
+    return swarm;
+}
+
+size_t SwarmQueue::size() const {
+    return heap.size();
+}
+
+// same step as advanceTime for Entities, only the swarms that land in this step are touched
+// (the order of arrivals in a step doesn't matter, stacks are capped at 5 either way and the duration is reset to the same value)
+void advanceTime(EntityStore& entities, SwarmQueue& swarms, int64_t step, const SimParameters& parameters) {
+    while (swarms.hasArrival(step)) {
+        QueuedSwarm swarm = swarms.popArrival();
+        EntityRef e = entities[swarm.targetIndex];
+        e.duration = parameters.hasCircle ? parameters.g_maxDuration * 0.75f : parameters.g_maxDuration;
+        setStacks(entities, swarm.targetIndex, e.stacks + swarm.stacks > 5 ? 5 : e.stacks + swarm.stacks);
+    }
+
+    EntityMask expired = decrementDurations(entities, parameters.timeDelta);
+    if ((expired[0] | expired[1]) == 0) {
+        return;
+    }
+    for (int word = 0; word < 2; word++) {
+        while (expired[word]) {
+            int index = word * 64 + findLowestBit(expired[word]);
+            expired[word] &= expired[word] - 1;
+            expireSwarm(index, entities, swarms.launched, parameters);
+        }
+    }
+    swarms.schedule(step + 1, parameters);
+}
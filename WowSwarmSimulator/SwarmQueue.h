@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "WowSwarmSimulator.h"
+#include "EntityStore.h"
+
+// traveling swarms of the fixed step loop ordered by their arrival step (min heap):
+// instead of counting timeToArrival up every step, the arrival step is computed once when the swarm starts traveling (see getTravelSteps)
+// and swarms are only touched again when they land.
+
+struct QueuedSwarm {
+    int64_t arrivalStep = 0;
+    int sourceIndex = 0;
+    int targetIndex = 0;
+    int stacks = 0;
+};
+
+class SwarmQueue {
+public:
+    // castSwarm/propagateSwarm add new swarms here, schedule moves them into the queue
+    std::vector<TravelingSwarm> launched;
+
+    // cast swarms start traveling in the step they are cast, propagated swarms in the step after they were propagated
+    void schedule(int64_t firstTravelStep, const SimParameters& parameters);
+    bool hasArrival(int64_t step) const {
+        return !heap.empty() && heap.front().arrivalStep <= step;
+    }
+    QueuedSwarm popArrival();
+    size_t size() const;
+    // the queued swarms in heap order
+    const std::vector<QueuedSwarm>& getQueued() const {
+        return heap;
+    }
+
+private:
+    std::vector<QueuedSwarm> heap;
+};
+
+void advanceTime(EntityStore& entities, SwarmQueue& swarms, int64_t step, const SimParameters& parameters);
@@ -0,0 +1,237 @@
+#include "SweepJob.h"
+#include "EntityStore.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos) {
+            return "";
+        }
+        size_t last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
+    }
+
+    std::string toUpper(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+        return text;
+    }
+
+    // the whole value has to be a number, "5x" or "" are errors
+    template<typename T>
+    T parseNumber(const std::string& value) {
+        std::istringstream stream{ value };
+        T number;
+        if (!(stream >> number) || !(stream >> std::ws).eof()) {
+            throw std::invalid_argument("expected a number but got \"" + value + "\"");
+        }
+        return number;
+    }
+
+    bool parseBool(const std::string& value) {
+        std::string upper = toUpper(value);
+        if (upper == "1" || upper == "TRUE") {
+            return true;
+        }
+        if (upper == "0" || upper == "FALSE") {
+            return false;
+        }
+        throw std::invalid_argument("expected true/false but got \"" + value + "\"");
+    }
+
+    std::vector<std::string> splitList(const std::string& value) {
+        std::vector<std::string> items;
+        std::istringstream stream{ value };
+        for (std::string item; std::getline(stream, item, ',');) {
+            items.push_back(trim(item));
+        }
+        if (items.empty()) {
+            throw std::invalid_argument("list is empty");
+        }
+        return items;
+    }
+
+    std::vector<size_t> parseCounts(const std::string& value) {
+        std::vector<size_t> counts;
+        for (const std::string& item : splitList(value)) {
+            int count = parseNumber<int>(item);
+            if (count < 1 || count > (int)maxSideEntities) {
+                throw std::invalid_argument("counts have to be between 1 and 64");
+            }
+            counts.push_back((size_t)count);
+        }
+        return counts;
+    }
+
+    // ALL adds the hand written strategies, e.g. "ALL, OPTIMAL" compares them with the solved policy
+    std::vector<TargetStrategy> parseStrategies(const std::string& value) {
+        std::vector<TargetStrategy> strategies;
+        for (const std::string& item : splitList(value)) {
+            if (toUpper(item) == "ALL") {
+                std::vector<TargetStrategy> all = getAllStrategies();
+                strategies.insert(strategies.end(), all.begin(), all.end());
+                continue;
+            }
+            auto name = std::find(stratNames.begin(), stratNames.end(), toUpper(item));
+            if (name == stratNames.end()) {
+                throw std::invalid_argument("unknown strategy \"" + item + "\"");
+            }
+            strategies.push_back(static_cast<TargetStrategy>(name - stratNames.begin()));
+        }
+        return strategies;
+    }
+
+    void setValue(SweepJob& job, const std::string& key, const std::string& value) {
+        SimParameters& p = job.parameters;
+        if (key == "g_splitChance") {
+            p.g_splitChance = parseNumber<float>(value);
+        }
+        else if (key == "g_maxDuration") {
+            p.g_maxDuration = parseNumber<float>(value);
+        }
+        else if (key == "g_cooldown") {
+            p.g_cooldown = parseNumber<float>(value);
+        }
+        else if (key == "g_maxTraveltime") {
+            p.g_maxTraveltime = parseNumber<float>(value);
+        }
+        else if (key == "simTime") {
+            p.simTime = parseNumber<float>(value);
+        }
+        else if (key == "timeDelta") {
+            p.timeDelta = parseNumber<float>(value);
+        }
+        else if (key == "eventDriven") {
+            p.eventDriven = parseBool(value);
+        }
+        else if (key == "seed") {
+            p.seed = parseNumber<int>(value);
+        }
+        else if (key == "threadCount") {
+            p.threadCount = parseNumber<int>(value);
+        }
+        else if (key == "replicate") {
+            p.replicate = parseBool(value);
+        }
+        else if (key == "replicaTime") {
+            p.replicaTime = parseNumber<float>(value);
+        }
+        else if (key == "warmupTime") {
+            p.warmupTime = parseNumber<float>(value);
+        }
+        else if (key == "ciRelativeHalfWidth") {
+            p.ciRelativeHalfWidth = parseNumber<float>(value);
+        }
+        else if (key == "minReplicas") {
+            p.minReplicas = parseNumber<int>(value);
+        }
+        else if (key == "maxReplicas") {
+            p.maxReplicas = parseNumber<int>(value);
+        }
+        else if (key == "laneReplicas") {
+            p.laneReplicas = parseBool(value);
+        }
+        else if (key == "exactChain") {
+            p.exactChain = parseBool(value);
+        }
+        else if (key == "chainMaxStates") {
+            p.chainMaxStates = parseNumber<int>(value);
+        }
+        else if (key == "chainBinWidth") {
+            p.chainBinWidth = parseNumber<float>(value);
+        }
+        else if (key == "chainTolerance") {
+            p.chainTolerance = parseNumber<double>(value);
+        }
+        else if (key == "policySampleTime") {
+            p.policySampleTime = parseNumber<float>(value);
+        }
+        else if (key == "policyTimeDelta") {
+            p.policyTimeDelta = parseNumber<float>(value);
+        }
+        else if (key == "policyRounds") {
+            p.policyRounds = parseNumber<int>(value);
+        }
+        else if (key == "policyRolloutChance") {
+            p.policyRolloutChance = parseNumber<float>(value);
+        }
+        else if (key == "policyHorizon") {
+            p.policyHorizon = parseNumber<int>(value);
+        }
+        else if (key == "policyTablePath") {
+            p.policyTablePath = value;
+        }
+        else if (key == "resultsPath") {
+            p.resultsPath = value;
+        }
+        else if (key == "resultsFormat") {
+            std::string format = toUpper(value);
+            if (format != "CSV" && format != "BINARY") {
+                throw std::invalid_argument("results format has to be csv or binary");
+            }
+            p.resultsFormat = format == "CSV" ? ResultsFormat::CSV : ResultsFormat::BINARY;
+        }
+        else if (key == "circles") {
+            job.grid.circles.clear();
+            for (const std::string& item : splitList(value)) {
+                job.grid.circles.push_back(parseBool(item));
+            }
+        }
+        else if (key == "friendlyCounts") {
+            job.grid.friendlyCounts = parseCounts(value);
+        }
+        else if (key == "enemyCounts") {
+            job.grid.enemyCounts = parseCounts(value);
+        }
+        else if (key == "strategies") {
+            job.grid.strategies = parseStrategies(value);
+        }
+        else {
+            throw std::invalid_argument("unknown key \"" + key + "\"");
+        }
+    }
+}
+
+SweepJob readSweepJob(std::istream& in) {
+    SweepJob job;
+    int lineNumber = 0;
+    for (std::string line; std::getline(in, line);) {
+        lineNumber++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            size_t separator = line.find('=');
+            if (separator == std::string::npos) {
+                throw std::invalid_argument("expected key = value");
+            }
+            setValue(job, trim(line.substr(0, separator)), trim(line.substr(separator + 1)));
+        }
+        catch (const std::invalid_argument& e) {
+            throw std::invalid_argument("line " + std::to_string(lineNumber) + ": " + e.what());
+        }
+    }
+
+    const SimParameters& p = job.parameters;
+    if (p.timeDelta <= 0 || p.simTime <= 0 || p.g_cooldown <= 0) {
+        throw std::invalid_argument("time step, sim time and cooldown have to be positive");
+    }
+    if (p.resultsPath.empty()) {
+        throw std::invalid_argument("results path is empty");
+    }
+    return job;
+}
+
+SweepJob readSweepJob(const std::string& path) {
+    std::ifstream inFile{ path };
+    if (!inFile) {
+        throw std::invalid_argument("can't open config file " + path);
+    }
+    return readSweepJob(inFile);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <istream>
+#include <string>
+
+#include "WowSwarmSimulator.h"
+
+// sweep of the headless runner, read from a text config file:
+// one "key = value" per line, # starts a comment. keys are the SimParameters member names (e.g. g_cooldown, simTime, seed, replicate,
+// resultsPath, resultsFormat = csv/binary) and the grid lists circles, friendlyCounts, enemyCounts and strategies (comma separated,
+// strategies by name, ALL adds all hand written ones). missing keys keep their defaults, i.e. the sweep of the GUI.
+
+struct SweepJob {
+    SimParameters parameters;
+    SweepGrid grid;
+};
+
+// throw std::invalid_argument with the line number on unknown keys, malformed values or configurations the sims can't run
+SweepJob readSweepJob(std::istream& in);
+SweepJob readSweepJob(const std::string& path);
@@ -0,0 +1,76 @@
+#include "SweepOutput.h"
+
+#include <stdexcept>
+
+namespace {
+    // raw bytes of the value, all supported targets (x86/x64) are little endian
+    template<typename T>
+    void writeValue(std::ofstream& outFile, const T& value) {
+        outFile.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+}
+
+SweepWriter::SweepWriter(const std::string& path, ResultsFormat format) : format(format) {
+    outFile.open(path, format == ResultsFormat::BINARY ? std::ios::binary : std::ios::out);
+    if (!outFile) {
+        throw std::invalid_argument("can't create results file " + path);
+    }
+    if (format == ResultsFormat::BINARY) {
+        outFile.write("SWRM", 4);
+        writeValue(outFile, binaryResultsVersion);
+        writeValue(outFile, binaryResultSize);
+    }
+    else {
+        outFile <<
+            "group_size;enemyCount;hasCircle;stratName;"
+            "friendlyCasts0;friendlyCasts1;friendlyCasts2;friendlyCasts3;friendlyCasts4;friendlyCasts5;"
+            "enemyCasts0;enemyCasts1;enemyCasts2;enemyCasts3;enemyCasts4;enemyCasts5;"
+            "ticksPerSecond;friendlyTicksPerTime;enemyTicksPerTime;"
+            "replicas;ticksPerSecondCI;friendlyTicksPerTimeCI;enemyTicksPerTimeCI\n";
+    }
+    outFile.flush();
+}
+
+void SweepWriter::write(const SimResult& res) {
+    if (format == ResultsFormat::BINARY) {
+        writeValue(outFile, static_cast<int32_t>(res.groupSize));
+        writeValue(outFile, static_cast<int32_t>(res.enemyCount));
+        writeValue(outFile, static_cast<uint8_t>(res.hasCircle ? 1 : 0));
+        outFile.write(res.stratName, sizeof(res.stratName));
+        for (int i = 0; i < 6; i++) {
+            writeValue(outFile, static_cast<int32_t>(res.friendlyCasts[i]));
+        }
+        for (int i = 0; i < 6; i++) {
+            writeValue(outFile, static_cast<int32_t>(res.enemyCasts[i]));
+        }
+        writeValue(outFile, res.ticksPerSecond);
+        writeValue(outFile, res.friendlyTicksPerSecond);
+        writeValue(outFile, res.enemyTicksPerSecond);
+        writeValue(outFile, static_cast<int32_t>(res.replicas));
+        writeValue(outFile, res.ticksPerSecondCI);
+        writeValue(outFile, res.friendlyTicksPerSecondCI);
+        writeValue(outFile, res.enemyTicksPerSecondCI);
+    }
+    else {
+        outFile << res.groupSize << ";" << res.enemyCount << ";";
+        if (res.hasCircle) {
+            outFile << "1;";
+        }
+        else {
+            outFile << "0;";
+        }
+        outFile << res.stratName << ";";
+        for (int i = 0; i < 6; i++) {
+            outFile << res.friendlyCasts[i] << ";";
+        }
+        for (int i = 0; i < 6; i++) {
+            outFile << res.enemyCasts[i] << ";";
+        }
+        outFile << res.ticksPerSecond << ";" << res.friendlyTicksPerSecond << ";" << res.enemyTicksPerSecond << ";";
+        outFile << res.replicas << ";" << res.ticksPerSecondCI << ";" << res.friendlyTicksPerSecondCI << ";" << res.enemyTicksPerSecondCI << "\n";
+    }
+    outFile.flush();
+    if (!outFile) {
+        throw std::runtime_error("can't write to the results file");
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <cstdint>
+
+#include "WowSwarmSimulator.h"
+
+// results file of a sweep, every row is written and flushed as soon as it arrives so a running or aborted sweep leaves all finished rows behind.
+// CSV: semicolon separated with a header line (same columns as before).
+// BINARY: header "SWRM", format version and record size (uint32 each), then one fixed size record per result,
+// fields in the order of SimResult, little endian ints/floats, hasCircle as 1 byte and stratName as 30 bytes (null padded).
+
+constexpr uint32_t binaryResultsVersion = 1;
+constexpr uint32_t binaryResultSize = 4 + 4 + 1 + 30 + 6 * 4 + 6 * 4 + 3 * 4 + 4 + 3 * 4;
+
+class SweepWriter {
+public:
+    // throws std::invalid_argument if the file can't be created
+    SweepWriter(const std::string& path, ResultsFormat format);
+    void write(const SimResult& result);
+
+private:
+    std::ofstream outFile;
+    ResultsFormat format;
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+#include "WowSwarmSimulator.h"
+#include "EntityStore.h"
+#include "OptimalPolicy.h"
+#include "MarkovChain.h"
+#include "SimRng.h"
+
+// the target strategies as policy types (side, scan order, stack threshold):
+// castSwarm<Policy> and the sim loops built on it are instantiated per policy, so the target selection is inlined
+// and the strategy is only dispatched once per sim (visitTargetPolicy) instead of once per cast.
+// selectTarget returns the entity index of the target, stack targets return -1 if nothing matches and fall back to a random target of the side.
+// isRandom marks the policies whose target is drawn uniformly from the side (the Markov chain enumerates those instead of drawing).
+
+// always the first entity of the side
+template<EntitySide Side>
+struct FocusTarget {
+    static constexpr bool hasFallback = false;
+    static constexpr bool isRandom = false;
+
+    template<typename EntityContainer>
+    static int selectTarget(EntityContainer& entities) {
+        return Side == EntitySide::ENEMY ? (int)entities.g_size : 0;
+    }
+};
+
+// random entity of the side regardless of stacks
+template<EntitySide Side>
+struct RandomTarget {
+    static constexpr bool hasFallback = false;
+    static constexpr bool isRandom = true;
+    static constexpr EntitySide side = Side;
+
+    template<typename EntityContainer>
+    static int selectTarget(EntityContainer& entities) {
+        if (Side == EntitySide::ENEMY) {
+            return (int)entities.g_size + (int)rng.nextBounded((uint32_t)entities.e_size);
+        }
+        return (int)rng.nextBounded((uint32_t)(Side == EntitySide::FRIENDLY ? entities.g_size : entities.size));
+    }
+};
+
+// first entity in scan order with MaxStacks stacks, then MaxStacks - 1, ... down to 0 stacks
+template<int MaxStacks, EntitySide Side, ScanOrder Order>
+struct StackTarget {
+    static constexpr bool hasFallback = true;
+    static constexpr bool isRandom = false;
+    typedef RandomTarget<Side> Fallback;
+
+    template<typename EntityContainer>
+    static int selectTarget(EntityContainer& entities) {
+        for (int targetStacks = MaxStacks; targetStacks >= 0; targetStacks--) {
+            int index = findEntity(entities, targetStacks, Side, Order);
+            if (index >= 0) {
+                return index;
+            }
+        }
+        return -1;
+    }
+};
+
+// first entity in scan order with the fewest stacks of the side
+template<EntitySide Side, ScanOrder Order>
+struct LowestTarget {
+    static constexpr bool hasFallback = false;
+    static constexpr bool isRandom = false;
+
+    template<typename EntityContainer>
+    static int selectTarget(EntityContainer& entities) {
+        return findEntity(entities, getLowestStacks(entities, Side), Side, Order);
+    }
+};
+
+// target of the policy with the fallback resolved in place (castSwarm draws a new travel time for the fallback instead)
+template<typename Policy, typename EntityContainer>
+int selectPolicyTarget(EntityContainer& entities) {
+    int index = Policy::selectTarget(entities);
+    if constexpr (Policy::hasFallback) {
+        if (index < 0) {
+            return selectPolicyTarget<typename Policy::Fallback>(entities);
+        }
+    }
+    return index;
+}
+
+// defined below, TableTarget dispatches the strategy the table falls back to
+template<typename Visitor>
+void visitTargetPolicy(const TargetStrategy strategy, Visitor&& visitor);
+
+// the target class of the solved lookup table (see OptimalPolicy.h), the states without an entry use the strategy the table was solved from
+// (LOWEST without a table, and every state if the table lost against its base strategy)
+struct TableTarget {
+    static constexpr bool hasFallback = false;
+    static constexpr bool isRandom = false;
+
+    // target of the table entry of the state, -1 if the state has no entry.
+    // a CHAIN table looks up the observation of the cast (see castObservedSwarm), without one it has no entries
+    template<typename EntityContainer>
+    static int selectTableTarget(EntityContainer& entities) {
+        if (!policyTable || policyTable->usesBase) {
+            return -1;
+        }
+        if (policyTable->chainPolicy) {
+            int targetClass = castObservation ? policyTable->chainPolicy->findTargetClass(*castObservation) : -1;
+            return targetClass >= 0 ? findEntity(entities, targetClass % 6, targetClass < 6 ? EntitySide::FRIENDLY : EntitySide::ENEMY, ScanOrder::ASCENDING) : -1;
+        }
+        const PolicyAction* action = policyTable->find(getPolicyState(entities));
+        return action ? findEntity(entities, action->stacks, action->side, ScanOrder::ASCENDING) : -1;
+    }
+
+    static TargetStrategy getBaseStrategy() {
+        TargetStrategy base = policyTable ? policyTable->baseStrategy : TargetStrategy::LOWEST;
+        if (base == TargetStrategy::OPTIMAL) {
+            throw std::logic_error("the policy table can't fall back to itself");
+        }
+        return base;
+    }
+
+    template<typename EntityContainer>
+    static int selectTarget(EntityContainer& entities) {
+        int index = selectTableTarget(entities);
+        if (index >= 0) {
+            return index;
+        }
+        visitTargetPolicy(getBaseStrategy(), [&](auto policy) {
+            index = selectPolicyTarget<decltype(policy)>(entities);
+        });
+        return index;
+    }
+};
+
+// a fallback cast draws a new travel time, same as a cast with the fallback strategy
+template<typename Policy, typename EntityContainer>
+void castSwarm(EntityContainer& entities, std::vector<TravelingSwarm>& travelingSwarms, SwarmStats& stats, const SimParameters& parameters) {
+    float travelTime = rng.nextFloat(parameters.g_maxTraveltime);
+    int index = Policy::selectTarget(entities);
+    if constexpr (Policy::hasFallback) {
+        if (index < 0) {
+            castSwarm<typename Policy::Fallback>(entities, travelingSwarms, stats, parameters);
+            return;
+        }
+    }
+    travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
+    stats.targetCasts[index >= entities.g_size][entities[index].stacks]++;
+}
+
+// castSwarm of the sim loops: with a CHAIN table the sim describes its durations and traveling swarms first (describe fills
+// remaining and swarms of the observation, the stacks are taken from the entities), every other policy casts right away
+template<typename Policy, typename EntityContainer, typename Describe>
+void castObservedSwarm(EntityContainer& entities, std::vector<TravelingSwarm>& travelingSwarms, SwarmStats& stats, const SimParameters& parameters, Describe&& describe) {
+    if constexpr (std::is_same_v<Policy, TableTarget>) {
+        if (policyTable && policyTable->chainPolicy && !policyTable->usesBase) {
+            CastObservation observation;
+            observation.stacks.resize(entities.size);
+            observation.remaining.resize(entities.size, 0.0f);
+            for (size_t index = 0; index < entities.size; index++) {
+                observation.stacks[index] = entities[index].stacks;
+            }
+            describe(observation);
+            castObservation = &observation;
+            castSwarm<Policy>(entities, travelingSwarms, stats, parameters);
+            castObservation = nullptr;
+            return;
+        }
+    }
+    castSwarm<Policy>(entities, travelingSwarms, stats, parameters);
+}
+
+// calls visitor with the policy of the strategy (ENEMYFIRST strategies scan descending, i.e. enemies first and the last entity on ties)
+template<typename Visitor>
+void visitTargetPolicy(const TargetStrategy strategy, Visitor&& visitor) {
+    switch (strategy) {
+    case TargetStrategy::FOCUSFRIENDLY: visitor(FocusTarget<EntitySide::FRIENDLY>{}); return;
+    case TargetStrategy::FOCUSENEMY: visitor(FocusTarget<EntitySide::ENEMY>{}); return;
+    case TargetStrategy::RANDOM: visitor(RandomTarget<EntitySide::ANY>{}); return;
+    case TargetStrategy::RANDOMENEMY: visitor(RandomTarget<EntitySide::ENEMY>{}); return;
+    case TargetStrategy::RANDOMFRIENDLY: visitor(RandomTarget<EntitySide::FRIENDLY>{}); return;
+    case TargetStrategy::ONESTACK: visitor(StackTarget<1, EntitySide::ANY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::ONESTACKENEMYFIRST: visitor(StackTarget<1, EntitySide::ANY, ScanOrder::DESCENDING>{}); return;
+    case TargetStrategy::ONESTACKENEMY: visitor(StackTarget<1, EntitySide::ENEMY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::ONESTACKFRIENDLY: visitor(StackTarget<1, EntitySide::FRIENDLY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::TWOSTACKS: visitor(StackTarget<2, EntitySide::ANY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::TWOSTACKSENEMYFIRST: visitor(StackTarget<2, EntitySide::ANY, ScanOrder::DESCENDING>{}); return;
+    case TargetStrategy::TWOSTACKSENEMY: visitor(StackTarget<2, EntitySide::ENEMY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::TWOSTACKSFRIENDLY: visitor(StackTarget<2, EntitySide::FRIENDLY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::THREESTACKS: visitor(StackTarget<3, EntitySide::ANY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::THREESTACKSENEMYFIRST: visitor(StackTarget<3, EntitySide::ANY, ScanOrder::DESCENDING>{}); return;
+    case TargetStrategy::THREESTACKSENEMY: visitor(StackTarget<3, EntitySide::ENEMY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::THREESTACKSFRIENDLY: visitor(StackTarget<3, EntitySide::FRIENDLY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::LOWEST: visitor(LowestTarget<EntitySide::ANY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::LOWESTENEMYFIRST: visitor(LowestTarget<EntitySide::ANY, ScanOrder::DESCENDING>{}); return;
+    case TargetStrategy::LOWESTENEMY: visitor(LowestTarget<EntitySide::ENEMY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::LOWESTFRIENDLY: visitor(LowestTarget<EntitySide::FRIENDLY, ScanOrder::ASCENDING>{}); return;
+    case TargetStrategy::OPTIMAL: visitor(TableTarget{}); return;
+    }
+    throw std::invalid_argument("unknown target strategy");
+}
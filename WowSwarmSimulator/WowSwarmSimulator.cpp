@@ -1,25 +1,33 @@
 
 #include "WowSwarmSimulator.h"
+#include "EventSimulator.h"
+#include "SimRng.h"
+#include "Replication.h"
+#include "EntityStore.h"
+#include "SwarmQueue.h"
+#include "TargetPolicies.h"
+#include "SweepOutput.h"
+#include "MarkovChain.h"
+#include "OptimalPolicy.h"
 
 #include <iostream>
-#include <fstream>
-#include <filesystem>
 #include <thread>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <map>
+#include <set>
+#include <tuple>
 
-// Choose a random mean between 1 and 6
-std::random_device dev;
-std::mt19937 rng(dev());
-std::uniform_int_distribution<std::mt19937::result_type> dist13(1, 3);
-std::uniform_int_distribution<std::mt19937::result_type> dist15(1, 5);
-std::uniform_int_distribution<std::mt19937::result_type> dist12(1, 2);
-std::uniform_real_distribution<> splitDist(0.0, 1.0);
+// every thread has its own generator, sweep tasks and realtime sims select their stream with seedSimRng
+thread_local SimRng rng;
 
 std::vector<int> getRandomIndices(size_t interval, size_t count) {
     std::vector<int> v(interval);
     std::iota(std::begin(v), std::end(v), 0);
     for (int i = 0; i < count; i++) {
-        std::uniform_int_distribution<std::mt19937::result_type> dist(0, (int)interval - 1 - i);
-        int j = dist(rng);
+        int j = (int)rng.nextBounded((uint32_t)(interval - i));
         v[i] = v[j];
         v[j] = i;
     }
@@ -38,348 +46,136 @@ void InitializeEntities(E_vec& group, E_vec& enemies, Entities& entities, Initia
     case InitialConfiguration::RANDOM: {
         for (auto& e : group) {
             e.duration = parameters.g_maxDuration;
-            e.stacks = dist13(rng);
+            e.stacks = rng.nextInt(1, 3);
         }
         for (auto& e : enemies) {
             e.duration = parameters.g_maxDuration;
-            e.stacks = dist13(rng);
+            e.stacks = rng.nextInt(1, 3);
         }
     }return;
     case InitialConfiguration::REALISTIC: {
-        std::uniform_int_distribution<std::mt19937::result_type> dist0es(0, (int)group.size() + (int)enemies.size() - 1);
         std::vector<int> targetIndices = getRandomIndices(group.size() + enemies.size(), 6);
         for (int i = 0; i < 4; i++) {
             int& index = targetIndices[i];
             entities[index].duration = parameters.g_maxDuration;
-            entities[index].stacks = dist12(rng);
+            entities[index].stacks = rng.nextInt(1, 2);
         }
         for (int i = 4; i < 6; i++) {
             int& index = targetIndices[i];
             entities[index].duration = parameters.g_maxDuration;
-            entities[index].stacks = dist15(rng);
+            entities[index].stacks = rng.nextInt(1, 5);
         }
     }return;
     }
 }
 
-void castSwarm(Entities& entities, std::vector<TravelingSwarm>& travelingSwarms, const TargetStrategy strategy, SwarmStats& stats, const SimParameters& parameters) {
-    std::uniform_real_distribution<float> travelDist(0.0, parameters.g_maxTraveltime);
-    float travelTime = travelDist(rng);
+void setStacks(Entities& entities, int index, int stacks) {
+    entities[index].stacks = stacks;
+}
 
-    switch (strategy) {
-    case TargetStrategy::FOCUSFRIENDLY: {
-        travelingSwarms.push_back({ 0, 0, -travelTime, travelTime, 3 });
-        stats.targetCasts[0][entities[0].stacks]++;
-    }return;
-    case TargetStrategy::FOCUSENEMY: {
-        travelingSwarms.push_back({ 0, (int)entities.g_size, -travelTime, travelTime, 3 });
-        stats.targetCasts[1][entities[entities.g_size].stacks]++;
-    }return;
-    case TargetStrategy::ONESTACK: {
-        for (int targetStacks = 1; targetStacks >= 0; targetStacks--) {
-            for (int index = 0; index < entities.size; index++) {
-                int& stacks = entities[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[index >= entities.g_size][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOM, stats, parameters);
-        return;
-    };
-    case TargetStrategy::ONESTACKENEMYFIRST: {
-        for (int targetStacks = 1; targetStacks >= 0; targetStacks--) {
-            for (int index = (int)entities.size - 1; index >= 0; index--) {
-                int& stacks = entities[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[index >= entities.g_size][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOM, stats, parameters);
-        return;
-    };
-    case TargetStrategy::ONESTACKENEMY: {
-        for (int targetStacks = 1; targetStacks >= 0; targetStacks--) {
-            for (int index = 0; index < entities.e_size; index++) {
-                int& stacks = (*entities.enemies)[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, (int)entities.g_size + index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[1][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOMENEMY, stats, parameters);
-        return;
-    };
-    case TargetStrategy::ONESTACKFRIENDLY: {
-        for (int targetStacks = 1; targetStacks >= 0; targetStacks--) {
-            for (int index = 0; index < entities.g_size; index++) {
-                int& stacks = (*entities.group)[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[0][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOMFRIENDLY, stats, parameters);
-        return;
-    };
-    case TargetStrategy::TWOSTACKS: {
-        for (int targetStacks = 2; targetStacks >= 0; targetStacks--) {
-            for (int index = 0; index < entities.size; index++) {
-                int& stacks = entities[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[index >= entities.g_size][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOM, stats, parameters);
-        return;
-    };
-    case TargetStrategy::TWOSTACKSENEMYFIRST: {
-        for (int targetStacks = 2; targetStacks >= 0; targetStacks--) {
-            for (int index = (int)entities.size - 1; index >= 0; index--) {
-                int& stacks = entities[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[index >= entities.g_size][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOM, stats, parameters);
-        return;
-    };
-    case TargetStrategy::TWOSTACKSENEMY: {
-        for (int targetStacks = 2; targetStacks >= 0; targetStacks--) {
-            for (int index = 0; index < entities.e_size; index++) {
-                int& stacks = (*entities.enemies)[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, (int)entities.g_size + index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[1][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOMENEMY, stats, parameters);
-        return;
-    };
-    case TargetStrategy::TWOSTACKSFRIENDLY: {
-        for (int targetStacks = 2; targetStacks >= 0; targetStacks--) {
-            for (int index = 0; index < entities.g_size; index++) {
-                int& stacks = (*entities.group)[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[0][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOMFRIENDLY, stats, parameters);
-        return;
-    };
-    case TargetStrategy::THREESTACKS: {
-        for (int targetStacks = 3; targetStacks >= 0; targetStacks--) {
-            for (int index = 0; index < entities.size; index++) {
-                int& stacks = entities[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[index >= entities.g_size][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOM, stats, parameters);
-        return;
-    };
-    case TargetStrategy::THREESTACKSENEMYFIRST: {
-        for (int targetStacks = 3; targetStacks >= 0; targetStacks--) {
-            for (int index = (int)entities.size - 1; index >= 0; index--) {
-                int& stacks = entities[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[index >= entities.g_size][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOM, stats, parameters);
-        return;
-    };
-    case TargetStrategy::THREESTACKSENEMY: {
-        for (int targetStacks = 3; targetStacks >= 0; targetStacks--) {
-            for (int index = 0; index < entities.e_size; index++) {
-                int& stacks = (*entities.enemies)[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, (int)entities.g_size + index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[1][stacks]++;
-                    return;
-                }
+int findEntity(Entities& entities, int stacks, EntitySide side, ScanOrder order) {
+    int first = side == EntitySide::ENEMY ? (int)entities.g_size : 0;
+    int last = side == EntitySide::FRIENDLY ? (int)entities.g_size : (int)entities.size;
+    if (order == ScanOrder::ASCENDING) {
+        for (int index = first; index < last; index++) {
+            if (entities[index].stacks == stacks) {
+                return index;
             }
         }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOMENEMY, stats, parameters);
-        return;
-    };
-    case TargetStrategy::THREESTACKSFRIENDLY: {
-        for (int targetStacks = 3; targetStacks >= 0; targetStacks--) {
-            for (int index = 0; index < entities.g_size; index++) {
-                int& stacks = (*entities.group)[index].stacks;
-                if (stacks == targetStacks) {
-                    travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-                    stats.targetCasts[0][stacks]++;
-                    return;
-                }
-            }
-        }
-        castSwarm(entities, travelingSwarms, TargetStrategy::RANDOMFRIENDLY, stats, parameters);
-        return;
-    };
-    case TargetStrategy::RANDOM: {
-        std::uniform_int_distribution<std::mt19937::result_type> dist(0, (int)entities.size - 1);
-        int index = dist(rng);
-        travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-        stats.targetCasts[index >= entities.g_size][entities[index].stacks]++;
-    }return;
-    case TargetStrategy::RANDOMENEMY: {
-        std::uniform_int_distribution<std::mt19937::result_type> dist(0, (int)entities.e_size - 1);
-        int index = (int)entities.g_size + dist(rng);
-        travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-        stats.targetCasts[index >= entities.g_size][entities[index].stacks]++;
-    }return;
-    case TargetStrategy::RANDOMFRIENDLY: {
-        std::uniform_int_distribution<std::mt19937::result_type> dist(0, (int)entities.g_size - 1);
-        int index = dist(rng);
-        travelingSwarms.push_back({ 0, index, -travelTime, travelTime, 3 });
-        stats.targetCasts[index >= entities.g_size][entities[index].stacks]++;
-    }return;
-    case TargetStrategy::LOWEST: {
-        int lowestStacks = INT_MAX;
-        int lowestIndex = 0;
-        for (int index = 0; index < entities.size; index++) {
-            int& stacks = entities[index].stacks;
-            if (stacks < lowestStacks) {
-                lowestStacks = stacks;
-                lowestIndex = index;
-            }
-        }
-        travelingSwarms.push_back({ 0, lowestIndex, -travelTime, travelTime, 3 });
-        stats.targetCasts[lowestIndex >= entities.g_size][lowestStacks]++;
-    }return;
-    case TargetStrategy::LOWESTENEMYFIRST: {
-        int lowestStacks = INT_MAX;
-        int lowestIndex = 0;
-        for (int index = 0; index < entities.size; index++) {
-            int& stacks = entities[index].stacks;
-            if (stacks <= lowestStacks) {
-                lowestStacks = stacks;
-                lowestIndex = index;
-            }
-        }
-        travelingSwarms.push_back({ 0, lowestIndex, -travelTime, travelTime, 3 });
-        stats.targetCasts[lowestIndex >= entities.g_size][lowestStacks]++;
-    }return;
-    case TargetStrategy::LOWESTENEMY: {
-        int lowestStacks = INT_MAX;
-        int lowestIndex = 0;
-        for (int index = 0; index < entities.e_size; index++) {
-            int& stacks = (*entities.enemies)[index].stacks;
-            if (stacks < lowestStacks) {
-                lowestStacks = stacks;
-                lowestIndex = index;
-            }
-        }
-        travelingSwarms.push_back({ 0, (int)entities.g_size + lowestIndex, -travelTime, travelTime, 3 });
-        stats.targetCasts[1][lowestStacks]++;
-    }return;
-    case TargetStrategy::LOWESTFRIENDLY: {
-        int lowestStacks = INT_MAX;
-        int lowestIndex = 0;
-        for (int index = 0; index < entities.g_size; index++) {
-            int& stacks = (*entities.group)[index].stacks;
-            if (stacks < lowestStacks) {
-                lowestStacks = stacks;
-                lowestIndex = index;
+    }
+    else {
+        for (int index = last - 1; index >= first; index--) {
+            if (entities[index].stacks == stacks) {
+                return index;
             }
         }
-        travelingSwarms.push_back({ 0, lowestIndex, -travelTime, travelTime, 3 });
-        stats.targetCasts[0][lowestStacks]++;
-    }return;
     }
+    return -1;
 }
 
-void propagateSwarm(int sourceIndex, int stacks, bool wasFriendly, Entities& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters) {
-    std::uniform_real_distribution<float> travelDist(0.0, parameters.g_maxTraveltime);
-    if (wasFriendly) {
-        int possibleTargetsCount = 0;
-        for (int i = 0; i < entities.e_size; i++) {
-            if ((*entities.enemies)[i].stacks == 0) {
-                possibleTargetsCount++;
-            }
+int countEntities(Entities& entities, int stacks, EntitySide side) {
+    int first = side == EntitySide::ENEMY ? (int)entities.g_size : 0;
+    int last = side == EntitySide::FRIENDLY ? (int)entities.g_size : (int)entities.size;
+    int count = 0;
+    for (int index = first; index < last; index++) {
+        if (entities[index].stacks == stacks) {
+            count++;
         }
-        if (possibleTargetsCount == 0) {
-            std::uniform_int_distribution<std::mt19937::result_type> dist(0, (int)entities.e_size - 1);
-            int index = dist(rng);
-            float travelTime = travelDist(rng);
-            travelingSwarms.push_back({ sourceIndex, (int)entities.g_size + index, -travelTime, travelTime, stacks - 1 });
-        }
-        else {
-            std::uniform_int_distribution<std::mt19937::result_type> dist(0, possibleTargetsCount - 1);
-            int preIndex = dist(rng);
-            int index = 0;
-            for (int i = 0; i < entities.e_size; i++) {
-                if ((*entities.enemies)[i].stacks == 0) {
-                    index = i;
-                    preIndex--;
-                    if (preIndex < 0) {
-                        break;
-                    }
-                }
-            }
-            float travelTime = travelDist(rng);
-            travelingSwarms.push_back({ sourceIndex, (int)entities.g_size + index, -travelTime, travelTime, stacks - 1 });
+    }
+    return count;
+}
+
+int getLowestStacks(Entities& entities, EntitySide side) {
+    int first = side == EntitySide::ENEMY ? (int)entities.g_size : 0;
+    int last = side == EntitySide::FRIENDLY ? (int)entities.g_size : (int)entities.size;
+    int lowestStacks = INT_MAX;
+    for (int index = first; index < last; index++) {
+        lowestStacks = std::min(lowestStacks, entities[index].stacks);
+    }
+    return lowestStacks;
+}
+
+int getNthEntity(Entities& entities, int stacks, EntitySide side, int n) {
+    int first = side == EntitySide::ENEMY ? (int)entities.g_size : 0;
+    int last = side == EntitySide::FRIENDLY ? (int)entities.g_size : (int)entities.size;
+    for (int index = first; index < last; index++) {
+        if (entities[index].stacks == stacks && n-- == 0) {
+            return index;
         }
     }
+    return -1;
+}
+
+// realtime sim: the strategy can change while running, so it is dispatched per cast
+template<typename EntityContainer>
+void castSwarm(EntityContainer& entities, std::vector<TravelingSwarm>& travelingSwarms, const TargetStrategy strategy, SwarmStats& stats, const SimParameters& parameters) {
+    visitTargetPolicy(strategy, [&](auto policy) {
+        castSwarm<decltype(policy)>(entities, travelingSwarms, stats, parameters);
+    });
+}
+
+// propagated swarms prefer a random entity without stacks on the other side
+template<typename EntityContainer>
+void propagateSwarm(int sourceIndex, int stacks, bool wasFriendly, EntityContainer& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters) {
+    EntitySide side = wasFriendly ? EntitySide::ENEMY : EntitySide::FRIENDLY;
+    int firstIndex = wasFriendly ? (int)entities.g_size : 0;
+    int sideSize = wasFriendly ? (int)entities.e_size : (int)entities.g_size;
+    int possibleTargetsCount = countEntities(entities, 0, side);
+    int index = 0;
+    if (possibleTargetsCount == 0) {
+        index = firstIndex + (int)rng.nextBounded((uint32_t)sideSize);
+    }
     else {
-        int possibleTargetsCount = 0;
-        for (int i = 0; i < entities.g_size; i++) {
-            if ((*entities.group)[i].stacks == 0) {
-                possibleTargetsCount++;
-            }
-        }
-        if (possibleTargetsCount == 0) {
-            std::uniform_int_distribution<std::mt19937::result_type> dist(0, (int)entities.g_size - 1);
-            int index = dist(rng);
-            float travelTime = travelDist(rng);
-            travelingSwarms.push_back({ sourceIndex, index, -travelTime, travelTime, stacks - 1 });
+        index = getNthEntity(entities, 0, side, (int)rng.nextBounded((uint32_t)possibleTargetsCount));
+    }
+    float travelTime = rng.nextFloat(parameters.g_maxTraveltime);
+    travelingSwarms.push_back({ sourceIndex, index, -travelTime, travelTime, stacks - 1 });
+}
+
+// removes the swarm of an entity whose debuff/buff ran out, swarms with more than one stack jump to the other side (split or not)
+template<typename EntityContainer>
+void expireSwarm(int index, EntityContainer& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters) {
+    auto&& e = entities[index];
+    bool wasFriendly = index < entities.g_size;
+    if (e.stacks > 1) {
+        if (rng.nextFloat() > parameters.g_splitChance) {
+            propagateSwarm(index, e.stacks, wasFriendly, entities, travelingSwarms, parameters);
         }
         else {
-            std::uniform_int_distribution<std::mt19937::result_type> dist(0, possibleTargetsCount - 1);
-            int preIndex = dist(rng);
-            int index = 0;
-            for (int i = 0; i < entities.g_size; i++) {
-                if ((*entities.group)[i].stacks == 0) {
-                    index = i;
-                    preIndex--;
-                    if (preIndex < 0) {
-                        break;
-                    }
-                }
-            }
-            float travelTime = travelDist(rng);
-            travelingSwarms.push_back({ sourceIndex, index, -travelTime, travelTime, stacks - 1 });
+            propagateSwarm(index, e.stacks, wasFriendly, entities, travelingSwarms, parameters);
+            propagateSwarm(index, e.stacks, wasFriendly, entities, travelingSwarms, parameters);
         }
     }
+    setStacks(entities, index, 0);
 }
 
+template void castSwarm(Entities& entities, std::vector<TravelingSwarm>& travelingSwarms, const TargetStrategy strategy, SwarmStats& stats, const SimParameters& parameters);
+template void castSwarm(EntityStore& entities, std::vector<TravelingSwarm>& travelingSwarms, const TargetStrategy strategy, SwarmStats& stats, const SimParameters& parameters);
+template void propagateSwarm(int sourceIndex, int stacks, bool wasFriendly, Entities& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters);
+template void propagateSwarm(int sourceIndex, int stacks, bool wasFriendly, EntityStore& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters);
+template void expireSwarm(int index, Entities& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters);
+template void expireSwarm(int index, EntityStore& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters);
+
 void advanceTime(Entities& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters) {
     std::vector<TravelingSwarm>::iterator it = travelingSwarms.begin();
     while(it != travelingSwarms.end()) {
@@ -400,16 +196,7 @@ void advanceTime(Entities& entities, std::vector<TravelingSwarm>& travelingSwarm
         if (e.duration > 0) {
             e.duration -= parameters.timeDelta;
             if (e.duration <= 0) {
-                if (e.stacks > 1) {
-                    if (splitDist(rng) > parameters.g_splitChance) {
-                        propagateSwarm(index, e.stacks, true, entities, travelingSwarms, parameters);
-                    }
-                    else {
-                        propagateSwarm(index, e.stacks, true, entities, travelingSwarms, parameters);
-                        propagateSwarm(index, e.stacks, true, entities, travelingSwarms, parameters);
-                    }
-                }
-                e.stacks = 0;
+                expireSwarm(index, entities, travelingSwarms, parameters);
             }
         }
     }
@@ -419,16 +206,7 @@ void advanceTime(Entities& entities, std::vector<TravelingSwarm>& travelingSwarm
         if (e.duration > 0) {
             e.duration -= parameters.timeDelta;
             if (e.duration <= 0) {
-                if (e.stacks > 1) {
-                    if (splitDist(rng) > parameters.g_splitChance) {
-                        propagateSwarm((int)entities.g_size + index, e.stacks, false, entities, travelingSwarms, parameters);
-                    }
-                    else {
-                        propagateSwarm((int)entities.g_size + index, e.stacks, false, entities, travelingSwarms, parameters);
-                        propagateSwarm((int)entities.g_size + index, e.stacks, false, entities, travelingSwarms, parameters);
-                    }
-                }
-                e.stacks = 0;
+                expireSwarm((int)entities.g_size + index, entities, travelingSwarms, parameters);
             }
         }
     }
@@ -466,40 +244,9 @@ void printStats(size_t friendlyCount, size_t enemyCount, SwarmStats stats, std::
     std::cout << "Friendly ticks/s: " << stats.friendlyTicks * 1.0f / stats.simTime << "\n\n";
 }
 
-template<size_t T>
-void exportResults(std::array<SimResult, T>* results) {
-    std::filesystem::path resPath = "C:\\Users\\Tobi\\Documents\\Programming\\Small_projects\\wow_swarm_simulator_visualization\\SwarmResults.csv";
-    if (!std::filesystem::is_directory(resPath.parent_path())) {
-        return;
-    }
-    std::ofstream outFile{ resPath };
-    outFile <<
-        "group_size;enemyCount;hasCircle;stratName;"
-        "friendlyCasts0;friendlyCasts1;friendlyCasts2;friendlyCasts3;friendlyCasts4;friendlyCasts5;"
-        "enemyCasts0;enemyCasts1;enemyCasts2;enemyCasts3;enemyCasts4;enemyCasts5;"
-        "ticksPerSecond;friendlyTicksPerTime;enemyTicksPerTime\n";
-    for (SimResult& res : *results) {
-        outFile << res.groupSize << ";" << res.enemyCount << ";";
-        if (res.hasCircle) {
-            outFile << "1;";
-        }
-        else {
-            outFile << "0;";
-        }
-        outFile << res.stratName << ";";
-        for (int i = 0; i < 6; i++) {
-            outFile << res.friendlyCasts[i] << ";";
-        }
-        for (int i = 0; i < 6; i++) {
-            outFile << res.enemyCasts[i] << ";";
-        }
-        outFile << res.ticksPerSecond << ";" << res.friendlyTicksPerSecond << ";" << res.enemyTicksPerSecond << "\n";
-    }
-    outFile.close();
-}
-
 void RunRealtimeSim(SimParameters& parameters, SimData& simData) {
     simData.isRunning = true;
+    seedSimRng(static_cast<uint64_t>(parameters.seed), 0, 0);
 
     InitializeEntities(simData.group, simData.enemies, simData.entities, parameters.initConfig, parameters);
 
@@ -540,85 +287,209 @@ void RunRealtimeSim(SimParameters& parameters, SimData& simData) {
     simData.isRunning = false;
 }
 
-void RunSim(const SimParameters& parameters)
-{
-    constexpr std::array<TargetStrategy, 21> strategies{ 
-        TargetStrategy::FOCUSFRIENDLY,
-        TargetStrategy::FOCUSENEMY,
-        TargetStrategy::RANDOM,
-        TargetStrategy::RANDOMENEMY, 
-        TargetStrategy::RANDOMFRIENDLY,
-        TargetStrategy::ONESTACK,
-        TargetStrategy::ONESTACKENEMYFIRST,
-        TargetStrategy::ONESTACKENEMY,
-        TargetStrategy::ONESTACKFRIENDLY,
-        TargetStrategy::TWOSTACKS,
-        TargetStrategy::TWOSTACKSENEMYFIRST,
-        TargetStrategy::TWOSTACKSENEMY,
-        TargetStrategy::TWOSTACKSFRIENDLY,
-        TargetStrategy::THREESTACKS,
-        TargetStrategy::THREESTACKSENEMYFIRST,
-        TargetStrategy::THREESTACKSENEMY,
-        TargetStrategy::THREESTACKSFRIENDLY,
-        TargetStrategy::LOWEST,
-        TargetStrategy::LOWESTENEMYFIRST,
-        TargetStrategy::LOWESTENEMY,
-        TargetStrategy::LOWESTFRIENDLY,
-    };
+// selects the stream of the rng of the calling thread, the numbers only depend on the master seed, the config and the replica (not on the thread)
+void seedSimRng(uint64_t masterSeed, uint32_t config, uint32_t replica) {
+    rng = SimRng(masterSeed, config, replica);
+}
+
+std::vector<TargetStrategy> getAllStrategies() {
+    std::vector<TargetStrategy> strategies;
+    for (size_t i = 0; i < (size_t)TargetStrategy::OPTIMAL; i++) {
+        strategies.push_back(static_cast<TargetStrategy>(i));
+    }
+    return strategies;
+}
 
-    constexpr std::array<size_t, 3> friendlyCounts{1, 5, 20};
-    constexpr std::array<size_t, 10> enemyCounts{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+size_t SweepGrid::getTaskCount() const {
+    return circles.size() * friendlyCounts.size() * enemyCounts.size() * strategies.size();
+}
 
-    std::array<SimResult, 2 * friendlyCounts.size() * enemyCounts.size() * stratNames.size()>* results = new std::array<SimResult, 2 * friendlyCounts.size()* enemyCounts.size()* stratNames.size()>();
-    size_t resCounter = 0;
+// configuration of a sweep task, task indices are ordered by circle, group size, enemy count and strategy (same order as the exported results)
+// (with the default grid a task index is the same configuration, and so the same rng stream, as before the grid was configurable)
+SweepConfig getSweepConfig(const SweepGrid& grid, size_t taskIndex) {
+    SweepConfig config;
+    config.strategyIndex = static_cast<size_t>(grid.strategies[taskIndex % grid.strategies.size()]);
+    taskIndex /= grid.strategies.size();
+    config.enemyCount = grid.enemyCounts[taskIndex % grid.enemyCounts.size()];
+    taskIndex /= grid.enemyCounts.size();
+    config.friendlyCount = grid.friendlyCounts[taskIndex % grid.friendlyCounts.size()];
+    taskIndex /= grid.friendlyCounts.size();
+    config.hasCircle = grid.circles[taskIndex % grid.circles.size()];
+    return config;
+}
 
-    for (auto& hasCircle : { false, true }) {
-        double resMaxDuration = hasCircle ? parameters.g_maxDuration * 0.75 : parameters.g_maxDuration;
-        for (auto& friendlyCount : friendlyCounts) {
-            for (auto& enemyCount : enemyCounts) {
-                for (size_t i = 0; i < strategies.size(); i++) {
-                    const auto& strategy = strategies[i];
-                    const auto& name = stratNames[i];
+// copies the strategy name into the fixed size field of the result (always null terminated)
+void setStratName(SimResult& r, size_t strategyIndex) {
+    size_t length = stratNames[strategyIndex].copy(r.stratName, sizeof(r.stratName) - 1);
+    r.stratName[length] = '\0';
+}
 
-                    E_vec group{ friendlyCount };
-                    E_vec enemies{ enemyCount };
-                    Entities entities{ group, enemies };
-                    std::vector<TravelingSwarm> travelingSwarms;
-                    SwarmStats stats;
-                    stats.simTime = parameters.simTime;
+// fixed step loop of runSwarmSim, instantiated per target policy
+template<typename Policy>
+void runFixedStepSim(EntityStore& entities, SwarmStats& stats, const SimParameters& parameters, int64_t firstTickStep) {
+    SwarmQueue swarms;
+    double cooldown = parameters.g_cooldown;
+    int64_t step = 1;
+    for (double time = 0; time < parameters.simTime; time += parameters.timeDelta) {
+        cooldown -= parameters.timeDelta;
+        if (cooldown <= 0) {
+            cooldown += parameters.g_cooldown;
+            castObservedSwarm<Policy>(entities, swarms.launched, stats, parameters, [&](CastObservation& observation) {
+                // the duration is decremented once more in this step
+                for (size_t index = 0; index < entities.size; index++) {
+                    observation.remaining[index] = std::max(0.0f, entities.durations[index] - parameters.timeDelta);
+                }
+                for (const QueuedSwarm& swarm : swarms.getQueued()) {
+                    observation.swarms.push_back({ swarm.targetIndex, swarm.stacks, (swarm.arrivalStep - step) * parameters.timeDelta });
+                }
+            });
+            swarms.schedule(step, parameters);
+        }
 
-                    InitializeEntities(group, enemies, entities, InitialConfiguration::EMPTY, parameters);
+        advanceTime(entities, swarms, step, parameters);
 
-                    double cooldown = parameters.g_cooldown;
-                    for (double time = 0; time < parameters.simTime; time += parameters.timeDelta) {
-                        cooldown -= parameters.timeDelta;
-                        if (cooldown <= 0) {
-                            cooldown += parameters.g_cooldown;
-                            castSwarm(entities, travelingSwarms, strategy, stats, parameters);
-                        }
+        if (step >= firstTickStep) {
+            recordSwarmStats(entities, stats);
+        }
+        step++;
+    }
+}
 
-                        advanceTime(entities, travelingSwarms, parameters);
+// single run of a configuration starting empty, ticks of the first warmupTime seconds are not recorded
+SwarmStats runSwarmSim(size_t friendlyCount, size_t enemyCount, const TargetStrategy strategy, const SimParameters& parameters, float warmupTime) {
+    // the sweep always starts empty, so there is nothing to initialize besides the store itself
+    EntityStore entities{ friendlyCount, enemyCount };
+    SwarmStats stats;
+    stats.simTime = parameters.simTime - warmupTime;
 
-                        recordSwarmStats(entities, stats);
+    int64_t firstTickStep = getStepCount(warmupTime, parameters) + 1;
+    if (parameters.eventDriven) {
+        runEventSim(entities, strategy, stats, parameters, firstTickStep);
+    }
+    else {
+        visitTargetPolicy(strategy, [&](auto policy) {
+            runFixedStepSim<decltype(policy)>(entities, stats, parameters, firstTickStep);
+        });
+    }
+    return stats;
+}
+
+void runSweepTask(const SweepGrid& grid, size_t taskIndex, SimResult& r, const SimParameters& parameters) {
+    SweepConfig config = getSweepConfig(grid, taskIndex);
+    SimParameters taskParameters = parameters;
+    taskParameters.hasCircle = config.hasCircle;
+
+    seedSimRng(static_cast<uint64_t>(parameters.seed), static_cast<uint32_t>(taskIndex), 0);
+    SwarmStats stats = runSwarmSim(config.friendlyCount, config.enemyCount, static_cast<TargetStrategy>(config.strategyIndex), taskParameters);
+    //printStats(...)
+    r.groupSize = (int)config.friendlyCount;
+    r.enemyCount = (int)config.enemyCount;
+    r.hasCircle = config.hasCircle;
+    setStratName(r, config.strategyIndex);
+    r.ticksPerSecond = (stats.enemyTicks + stats.friendlyTicks) * taskParameters.timeDelta / stats.simTime;
+    r.enemyTicksPerSecond = stats.enemyTicks * taskParameters.timeDelta / stats.simTime;
+    r.friendlyTicksPerSecond = stats.friendlyTicks * taskParameters.timeDelta / stats.simTime;
+    r.friendlyCasts = stats.targetCasts[0];
+    r.enemyCasts = stats.targetCasts[1];
+}
+
+// runs all tasks of the sweep on a pool of threads and hands the results to onResult in task order: a finished task waits in a reorder buffer
+// until all tasks before it are done, so the results still stream but the files don't depend on the thread count
+void runSweep(const SweepGrid& grid, const SimParameters& parameters, const SweepResultHandler& onResult) {
+    const size_t taskCount = grid.getTaskCount();
+    size_t threadCount = parameters.threadCount > 0 ? (size_t)parameters.threadCount : std::thread::hardware_concurrency();
+    threadCount = std::max<size_t>(1, std::min(threadCount, taskCount));
+
+    std::unique_ptr<PolicyTableWriter> tableWriter;
+    bool hasOptimal = std::find(grid.strategies.begin(), grid.strategies.end(), TargetStrategy::OPTIMAL) != grid.strategies.end();
+    if (hasOptimal && !parameters.policyTablePath.empty()) {
+        tableWriter = std::make_unique<PolicyTableWriter>(parameters.policyTablePath);
+    }
+
+    std::atomic<size_t> nextTask{ 0 };
+    std::mutex resultMutex;
+    // finished tasks that wait for an earlier one, with the table of OPTIMAL tasks
+    std::map<size_t, std::pair<SimResult, std::unique_ptr<PolicyTable>>> pendingResults;
+    size_t nextResult = 0;
+    // configurations whose chain doesn't fit, the other strategies of the configuration are simulated without enumerating it again
+    std::mutex chainMutex;
+    std::set<std::tuple<size_t, size_t, bool>> unfitChains;
+    // the first exception of any task stops the sweep and is rethrown on the calling thread
+    std::exception_ptr error;
+    auto worker = [&]() {
+        for (size_t task = nextTask++; task < taskCount; task = nextTask++) {
+            try {
+                SimResult result;
+                // OPTIMAL tasks solve the policy of their configuration first, the sims of the task then run its table
+                SweepConfig config = getSweepConfig(grid, task);
+                bool isOptimal = static_cast<TargetStrategy>(config.strategyIndex) == TargetStrategy::OPTIMAL;
+                PolicyTable table;
+                if (isOptimal) {
+                    SimParameters policyParameters = parameters;
+                    policyParameters.hasCircle = config.hasCircle;
+                    table = solveOptimalPolicy(config.friendlyCount, config.enemyCount, policyParameters, static_cast<uint64_t>(parameters.seed), static_cast<uint32_t>(task));
+                    policyTable = &table;
+                }
+                // configurations the chain can't evaluate are simulated
+                bool isExact = false;
+                if (parameters.exactChain) {
+                    auto configuration = std::make_tuple(config.friendlyCount, config.enemyCount, config.hasCircle);
+                    std::unique_lock<std::mutex> chainLock(chainMutex);
+                    bool fits = unfitChains.count(configuration) == 0;
+                    chainLock.unlock();
+                    isExact = fits && runChainSweepTask(grid, task, result, parameters);
+                    if (fits && !isExact) {
+                        chainLock.lock();
+                        unfitChains.insert(configuration);
                     }
-                    //printStats(...)
-                    SimResult& r = (*results)[resCounter];
-                    r.groupSize = (int)friendlyCount;
-                    r.enemyCount = (int)enemyCount;
-                    r.hasCircle = hasCircle;
-                    strcpy_s(r.stratName, name.data());
-                    r.ticksPerSecond = (stats.enemyTicks + stats.friendlyTicks) * parameters.timeDelta / stats.simTime;
-                    r.enemyTicksPerSecond = stats.enemyTicks * parameters.timeDelta / stats.simTime;
-                    r.friendlyTicksPerSecond = stats.friendlyTicks * parameters.timeDelta / stats.simTime;
-                    r.friendlyCasts = stats.targetCasts[0];
-                    r.enemyCasts = stats.targetCasts[1];
-
-                    resCounter++;
                 }
+                if (!isExact && parameters.replicate) {
+                    runReplicatedSweepTask(grid, task, result, parameters);
+                }
+                else if (!isExact) {
+                    runSweepTask(grid, task, result, parameters);
+                }
+                policyTable = nullptr;
+                std::lock_guard<std::mutex> lock(resultMutex);
+                pendingResults.emplace(task, std::make_pair(result, isOptimal ? std::make_unique<PolicyTable>(std::move(table)) : nullptr));
+                for (auto next = pendingResults.begin(); next != pendingResults.end() && next->first == nextResult; next = pendingResults.begin()) {
+                    onResult(next->first, next->second.first);
+                    if (next->second.second && tableWriter) {
+                        tableWriter->write(*next->second.second);
+                    }
+                    pendingResults.erase(next);
+                    nextResult++;
+                }
+            }
+            catch (...) {
+                policyTable = nullptr;
+                std::lock_guard<std::mutex> lock(resultMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                nextTask = taskCount;
             }
         }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) {
+        t.join();
     }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
 
-    exportResults(results);
-    delete results;
-}
\ No newline at end of file
+// default sweep of the GUI, throws if the results file can't be written
+void RunSim(const SimParameters& parameters)
+{
+    SweepWriter writer{ parameters.resultsPath, parameters.resultsFormat };
+
+    runSweep(SweepGrid(), parameters, [&](size_t, const SimResult& result) {
+        writer.write(result);
+    });
+}
@@ -3,10 +3,13 @@
 #include <vector>
 #include <array>
 #include <stdexcept>
-#include <random>
 #include <numeric>
 #include <atomic>
 #include <mutex>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <functional>
 
 // settings: 
 // 5 man party or 20 man raid
@@ -88,12 +91,22 @@ struct SimResult {
     float ticksPerSecond = 0.0;
     float enemyTicksPerSecond = 0.0;
     float friendlyTicksPerSecond = 0.0;
+    // number of replicas and 95% confidence interval half widths of the tick rates (0 for a single run)
+    int replicas = 1;
+    float ticksPerSecondCI = 0.0;
+    float enemyTicksPerSecondCI = 0.0;
+    float friendlyTicksPerSecondCI = 0.0;
 };
 
 enum class InitialConfiguration {
     EMPTY, RANDOM, REALISTIC
 };
 
+// format of the sweep results file: semicolon separated text or fixed size little endian records (see SweepOutput.h)
+enum class ResultsFormat {
+    CSV, BINARY
+};
+
 constexpr std::array<std::string_view, 3> initConfigNames{
     "EMPTY",
     "RANDOM",
@@ -121,10 +134,11 @@ enum class TargetStrategy {
     LOWEST, // targets first enemy/friendly with the lowest amount of stacks
     LOWESTENEMYFIRST, // targets first enemy/friendly with the lowest amount of stacks but begins searching enemies
     LOWESTENEMY, // targets random enemy with the lowest amount of stacks
-    LOWESTFRIENDLY // targets random friendly with the lowest amount of stacks
+    LOWESTFRIENDLY, // targets random friendly with the lowest amount of stacks
+    OPTIMAL // targets by the solved lookup table of the configuration (see OptimalPolicy.h), like LOWEST without one and like its base strategy if it lost against it
 };
 
-constexpr std::array<std::string_view, 21> stratNames{
+constexpr std::array<std::string_view, 22> stratNames{
     "FOCUSFRIENDLY",
     "FOCUSENEMY",
     "RANDOM",
@@ -145,7 +159,8 @@ constexpr std::array<std::string_view, 21> stratNames{
     "LOWEST",
     "LOWESTENEMYFIRST",
     "LOWESTENEMY",
-    "LOWESTFRIENDLY"
+    "LOWESTFRIENDLY",
+    "OPTIMAL"
 };
 
 struct SimParameters {
@@ -162,6 +177,42 @@ struct SimParameters {
     int friendCount = 1;
     int enemyCount = 1;
     bool hasCircle = false;
+    // RunSim jumps from event to event instead of stepping every timeDelta (same statistics, see EventSimulator.h)
+    bool eventDriven = true;
+    // master seed of all sims and number of sweep threads (0 uses all cores), results only depend on the seed
+    int seed = 0;
+    int threadCount = 0;
+    // adaptive replication of the sweep: independent replicas of replicaTime seconds (after warmupTime seconds that are not recorded)
+    // until the 95% confidence interval half width of ticks/s is below ciRelativeHalfWidth * mean or maxReplicas are reached
+    bool replicate = false;
+    float replicaTime = 1000.0f;
+    float warmupTime = 500.0f;
+    float ciRelativeHalfWidth = 0.02f;
+    int minReplicas = 5;
+    int maxReplicas = 200;
+    // replicas of the fixed step loop are simulated 8 at a time in SIMD lanes (see LaneSimulator.h), same results as one after another,
+    // the lanes have no event driven version so they are only used with eventDriven = false
+    bool laneReplicas = false;
+    // configurations whose Markov chain with bins of chainBinWidth seconds has at most chainMaxStates states are evaluated by the chain
+    // instead of simulated (see MarkovChain.h), with the defaults the 1v1 ones. all other configurations are simulated as usual
+    bool exactChain = false;
+    int chainMaxStates = 1000000;
+    float chainBinWidth = 1.0f;
+    double chainTolerance = 1e-10;
+    // OPTIMAL solves the target policy of every sweep configuration (see OptimalPolicy.h): by policy iteration on the Markov chain
+    // if it fits into chainMaxStates, otherwise approximately by policyRounds rounds, each a run of policySampleTime seconds with
+    // policyTimeDelta that compares all targets of policyRolloutChance of its casts over the next policyHorizon casts.
+    // either table casts like its base strategy if it doesn't beat it in policySampleTime seconds of the sweep's sim with the same
+    // random numbers. the tables are written to policyTablePath (if not empty)
+    float policySampleTime = 100000.0f;
+    float policyTimeDelta = 0.1f;
+    int policyRounds = 5;
+    float policyRolloutChance = 0.25f;
+    int policyHorizon = 4;
+    std::string policyTablePath = "";
+    // file the sweep streams its results to, one row per configuration as soon as it is done
+    std::string resultsPath = "SwarmResults.csv";
+    ResultsFormat resultsFormat = ResultsFormat::CSV;
     
     /*
     float g_splitChance = 0.6f;
@@ -182,6 +233,39 @@ struct SimParameters {
     bool pauseSim = false;
 };
 
+// the hand written strategies, OPTIMAL has to be asked for since it solves a policy per configuration first
+std::vector<TargetStrategy> getAllStrategies();
+
+// configurations of a sweep: every combination of circle, group size, enemy count and strategy
+// (the defaults are the sweep of RunSim, the headless runner reads them from its config file)
+struct SweepGrid {
+    std::vector<bool> circles{ false, true };
+    std::vector<size_t> friendlyCounts{ 1, 5, 20 };
+    std::vector<size_t> enemyCounts{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    std::vector<TargetStrategy> strategies = getAllStrategies();
+
+    size_t getTaskCount() const;
+};
+
+// called once per configuration in task order (see runSweep), calls are serialized
+typedef std::function<void(size_t taskIndex, const SimResult& result)> SweepResultHandler;
+
+// side and scan order of the target search of the strategies: ascending searches the group first, descending the enemies first
+enum class EntitySide {
+    ANY, FRIENDLY, ENEMY
+};
+
+enum class ScanOrder {
+    ASCENDING, DESCENDING
+};
+
+struct SweepConfig {
+    bool hasCircle = false;
+    size_t friendlyCount = 0;
+    size_t enemyCount = 0;
+    size_t strategyIndex = 0;
+};
+
 struct SimData {
     mutable std::mutex m;
 
@@ -195,12 +279,28 @@ struct SimData {
 
 std::vector<int> getRandomIndices(size_t interval, size_t count);
 void InitializeEntities(E_vec& group, E_vec& enemies, Entities& entities, InitialConfiguration config, const SimParameters& parameters);
-void castSwarm(Entities& entities, std::vector<TravelingSwarm>& travelingSwarms, const TargetStrategy strategy, SwarmStats& stats, const SimParameters& parameters);
-void propagateSwarm(int sourceIndex, int stacks, bool wasFriendly, Entities& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters);
+// target search for the strategies, the overloads for EntityStore look up its stack buckets (see EntityStore.h)
+// findEntity/getNthEntity return entity indices or -1 if there is no match
+void setStacks(Entities& entities, int index, int stacks);
+int findEntity(Entities& entities, int stacks, EntitySide side, ScanOrder order);
+int countEntities(Entities& entities, int stacks, EntitySide side);
+int getLowestStacks(Entities& entities, EntitySide side);
+int getNthEntity(Entities& entities, int stacks, EntitySide side, int n);
+// the strategy and swarm functions work on Entities (AoS, used by the realtime sim) and EntityStore (SoA, used by the sweep)
+template<typename EntityContainer>
+void castSwarm(EntityContainer& entities, std::vector<TravelingSwarm>& travelingSwarms, const TargetStrategy strategy, SwarmStats& stats, const SimParameters& parameters);
+template<typename EntityContainer>
+void propagateSwarm(int sourceIndex, int stacks, bool wasFriendly, EntityContainer& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters);
+template<typename EntityContainer>
+void expireSwarm(int index, EntityContainer& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters);
 void advanceTime(Entities& entities, std::vector<TravelingSwarm>& travelingSwarms, const SimParameters& parameters);
 void recordSwarmStats(Entities& entities, SwarmStats& stats);
 void printStats(size_t friendlyCount, size_t enemyCount, SwarmStats stats, std::string_view name);
-template<size_t T>
-void exportResults(std::array<SimResult, T>* results);
+void seedSimRng(uint64_t masterSeed, uint32_t config, uint32_t replica);
+SweepConfig getSweepConfig(const SweepGrid& grid, size_t taskIndex);
+void setStratName(SimResult& r, size_t strategyIndex);
+SwarmStats runSwarmSim(size_t friendlyCount, size_t enemyCount, const TargetStrategy strategy, const SimParameters& parameters, float warmupTime = 0.0f);
+void runSweepTask(const SweepGrid& grid, size_t taskIndex, SimResult& r, const SimParameters& parameters);
+void runSweep(const SweepGrid& grid, const SimParameters& parameters, const SweepResultHandler& onResult);
 void RunRealtimeSim(SimParameters& parameters, SimData& simData);
 void RunSim(const SimParameters& parameters);
\ No newline at end of file
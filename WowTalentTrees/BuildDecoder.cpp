@@ -0,0 +1,127 @@
+#include "BuildDecoder.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <bit>
+
+namespace WowTalentTrees {
+    /*
+    Creates the decode table for a sorted DAG. The DAG has to be created from the same tree (and therefore has the same order) as the DAG
+    that was used to create the uint64 indices.
+    */
+    BuildDecoder createBuildDecoder(const TreeDAGInfo& sortedTreeDAG) {
+        if (sortedTreeDAG.sortedTalents.size() > 64)
+            throw std::logic_error("Number of talents exceeds 64, need different indexing type instead of uint64");
+        BuildDecoder decoder;
+
+        //expanded talents are named "INDEX_RANK" (see expandTalentAndAdvance), key is the same as in addTalentAndChildrenToMap
+        std::vector<std::string> indexToKey;
+        for (auto& talent : sortedTreeDAG.sortedTalents) {
+            std::vector<std::string> splitIndex = splitString(talent->index, "_");
+            std::string key = splitIndex[0];
+            if (talent->talentSwitch >= 0) {
+                key += std::to_string(talent->talentSwitch);
+            }
+            indexToKey.push_back(key);
+            decoder.indexToRank.push_back(splitIndex.size() > 1 ? std::stoi(splitIndex[1]) + 1 : 1);
+        }
+        decoder.talentKeys = indexToKey;
+        std::sort(decoder.talentKeys.begin(), decoder.talentKeys.end());
+        decoder.talentKeys.erase(std::unique(decoder.talentKeys.begin(), decoder.talentKeys.end()), decoder.talentKeys.end());
+
+        std::unordered_map<std::string, int> keyToTalent;
+        for (int i = 0; i < decoder.talentKeys.size(); i++) {
+            keyToTalent[decoder.talentKeys[i]] = i;
+            //sorted keys: if a key is a prefix of any other key it is a prefix of the following key
+            if (i > 0 && decoder.talentKeys[i].compare(0, decoder.talentKeys[i - 1].size(), decoder.talentKeys[i - 1]) == 0) {
+                decoder.sortPerBuild = true;
+            }
+        }
+        decoder.talentMasks.resize(decoder.talentKeys.size(), 0);
+        decoder.maxPoints.resize(decoder.talentKeys.size(), 0);
+        for (int i = 0; i < indexToKey.size(); i++) {
+            int talent = keyToTalent[indexToKey[i]];
+            decoder.indexToTalent.push_back(talent);
+            decoder.talentMasks[talent] |= 1ULL << i;
+            decoder.maxPoints[talent] += 1;
+        }
+        return decoder;
+    }
+
+    /*
+    Creates the decode table for a (not expanded) tree.
+    */
+    BuildDecoder createBuildDecoder(TalentTree tree) {
+        expandTreeTalents(tree);
+        TreeDAGInfo sortedTreeDAG = createSortedMinimalDAG(tree);
+        return createBuildDecoder(sortedTreeDAG);
+    }
+
+    /*
+    Transforms a uint64 index into the same string getTalentString would create for the filled out tree (see fillOutTreeWithBinaryIndexToString).
+    */
+    std::string decodeBuild(const BuildDecoder& decoder, uint64_t comb) {
+        if (decoder.sortPerBuild) {
+            std::vector<std::string> talentsAndPoints;
+            talentsAndPoints.reserve(decoder.talentKeys.size());
+            for (int i = 0; i < decoder.talentKeys.size(); i++) {
+                talentsAndPoints.push_back(decoder.talentKeys[i] + std::to_string(std::popcount(comb & decoder.talentMasks[i])));
+            }
+            std::sort(talentsAndPoints.begin(), talentsAndPoints.end());
+            std::string treeString;
+            for (auto& talentRepresentation : talentsAndPoints) {
+                treeString += talentRepresentation;
+                treeString += ';';
+            }
+            return treeString;
+        }
+
+        std::string treeString;
+        treeString.reserve(decoder.talentKeys.size() * 6);
+        for (int i = 0; i < decoder.talentKeys.size(); i++) {
+            treeString += decoder.talentKeys[i];
+            int points = std::popcount(comb & decoder.talentMasks[i]);
+            if (points < 10) {
+                treeString += static_cast<char>('0' + points);
+            }
+            else {
+                treeString += std::to_string(points);
+            }
+            treeString += ';';
+        }
+        return treeString;
+    }
+
+    /*
+    Transforms a uint64 index into a compact string with one character ('0' + points) per talent in the order of BuildDecoder::talentKeys.
+    */
+    std::string decodeBuildCompact(const BuildDecoder& decoder, uint64_t comb) {
+        std::string compact(decoder.talentKeys.size(), '0');
+        for (int i = 0; i < decoder.talentKeys.size(); i++) {
+            compact[i] = static_cast<char>('0' + std::popcount(comb & decoder.talentMasks[i]));
+        }
+        return compact;
+    }
+
+    /*
+    Batch version of decodeBuild/decodeBuildCompact, decodes in parallel.
+    */
+    std::vector<std::string> decodeBuilds(const BuildDecoder& decoder, const std::vector<uint64_t>& combinations, bool compact) {
+        std::vector<std::string> builds(combinations.size());
+#pragma omp parallel for
+        for (long long i = 0; i < static_cast<long long>(combinations.size()); i++) {
+            builds[i] = compact ? decodeBuildCompact(decoder, combinations[i]) : decodeBuild(decoder, combinations[i]);
+        }
+        return builds;
+    }
+
+    std::vector<std::string> decodeBuilds(const BuildDecoder& decoder, const std::vector<std::pair<std::bitset<128>, int>>& combinations, bool compact) {
+        std::vector<uint64_t> masks;
+        masks.reserve(combinations.size());
+        for (auto& comb : combinations) {
+            masks.push_back(comb.first.to_ullong());
+        }
+        return decodeBuilds(decoder, masks, compact);
+    }
+}
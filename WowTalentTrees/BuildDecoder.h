@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <bitset>
+#include <cstdint>
+
+#include "WowTalentTrees.h"
+
+namespace WowTalentTrees {
+    /*
+    Precomputed decode table that translates uint64 indices of the sorted DAG (see TreeDAGInfo) back to talents and ranks without touching
+    the tree. Talents are stored in the canonical order of getTalentString, every talent has a mask of all its expanded single point talents
+    so the rank of a talent is a single popcount.
+    */
+    struct BuildDecoder {
+        std::vector<std::string> talentKeys;
+        std::vector<uint64_t> talentMasks;
+        std::vector<int> maxPoints;
+        //per sorted DAG index: index of the talent in talentKeys and rank this single point talent represents
+        std::vector<int> indexToTalent;
+        std::vector<int> indexToRank;
+        //if a talent key is a prefix of another key the order of getTalentString depends on the points and every build has to be sorted
+        bool sortPerBuild = false;
+    };
+
+    BuildDecoder createBuildDecoder(const TreeDAGInfo& sortedTreeDAG);
+    BuildDecoder createBuildDecoder(TalentTree tree);
+    std::string decodeBuild(const BuildDecoder& decoder, uint64_t comb);
+    std::string decodeBuildCompact(const BuildDecoder& decoder, uint64_t comb);
+    std::vector<std::string> decodeBuilds(const BuildDecoder& decoder, const std::vector<uint64_t>& combinations, bool compact = false);
+    std::vector<std::string> decodeBuilds(const BuildDecoder& decoder, const std::vector<std::pair<std::bitset<128>, int>>& combinations, bool compact = false);
+}
@@ -0,0 +1,191 @@
+#include "BuildStore.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace WowTalentTrees {
+    /*
+    Helper function that appends combinations to the arena and releases their memory right away to keep the peak memory low.
+    */
+    void appendCombinations(BuildStore& store, std::vector<std::pair<std::bitset<128>, int>>& combinations) {
+        for (auto& comb : combinations) {
+            store.masks.push_back(comb.first.to_ullong());
+            if (comb.second < 1)
+                throw std::logic_error("Multiplier " + std::to_string(comb.second) + " is not positive");
+            store.multipliers.push_back(static_cast<uint32_t>(comb.second));
+        }
+        combinations.clear();
+        combinations.shrink_to_fit();
+    }
+
+    /*
+    Helper function that creates an empty store with reserved arena for the given number of builds.
+    */
+    BuildStore createEmptyBuildStore(int talentPoints, size_t buildCount) {
+        BuildStore store;
+        store.talentPoints = talentPoints;
+        store.masks.reserve(buildCount);
+        store.multipliers.reserve(buildCount);
+        store.budgetOffsets.push_back(0);
+        return store;
+    }
+
+    /*
+    Creates a store from the result of countConfigurationsFast (only the budget talentPoints is filled).
+    */
+    BuildStore createBuildStore(std::vector<std::pair<std::bitset<128>, int>> combinations, int talentPoints) {
+        BuildStore store = createEmptyBuildStore(talentPoints, combinations.size());
+        for (int i = 1; i < talentPoints; i++) {
+            store.budgetOffsets.push_back(0);
+        }
+        appendCombinations(store, combinations);
+        store.budgetOffsets.push_back(store.masks.size());
+        return store;
+    }
+
+    /*
+    Creates a store from the result of countConfigurationsFastParallel (combinations[i] holds the builds with i + 1 talent points).
+    */
+    BuildStore createBuildStore(std::vector<std::vector<std::pair<std::bitset<128>, int>>> combinations) {
+        size_t buildCount = 0;
+        for (auto& budgetCombinations : combinations) {
+            buildCount += budgetCombinations.size();
+        }
+        BuildStore store = createEmptyBuildStore(static_cast<int>(combinations.size()), buildCount);
+        for (auto& budgetCombinations : combinations) {
+            appendCombinations(store, budgetCombinations);
+            store.budgetOffsets.push_back(store.masks.size());
+        }
+        return store;
+    }
+
+    /*
+    Creates a store from the result of countConfigurationsFastParallelThreaded (threadCombinations[thread][i] holds builds with i + 1 talent points).
+    */
+    BuildStore createBuildStore(std::vector<std::vector<std::vector<std::pair<std::bitset<128>, int>>>> threadCombinations) {
+        if (threadCombinations.size() == 0)
+            return createEmptyBuildStore(0, 0);
+        int talentPoints = static_cast<int>(threadCombinations[0].size());
+        size_t buildCount = 0;
+        for (auto& combinations : threadCombinations) {
+            for (auto& budgetCombinations : combinations) {
+                buildCount += budgetCombinations.size();
+            }
+        }
+        BuildStore store = createEmptyBuildStore(talentPoints, buildCount);
+        for (int i = 0; i < talentPoints; i++) {
+            for (auto& combinations : threadCombinations) {
+                appendCombinations(store, combinations[i]);
+            }
+            store.budgetOffsets.push_back(store.masks.size());
+        }
+        return store;
+    }
+
+    /*
+    Creates a store from a (merged) shard result of the multi process count.
+    */
+    BuildStore createBuildStore(ShardResult shard) {
+        return createBuildStore(std::move(shard.combinations));
+    }
+
+    /*
+    Sorts every budget by index (budgets in parallel) and optionally removes duplicate builds. Duplicates always have the same multiplier
+    since the multiplier only depends on the selected talents.
+    */
+    void sortBuildStore(BuildStore& store, bool deduplicate) {
+        std::vector<size_t> budgetSizes(store.talentPoints);
+#pragma omp parallel for schedule(dynamic)
+        for (int b = 0; b < store.talentPoints; b++) {
+            size_t begin = store.budgetOffsets[b];
+            size_t end = store.budgetOffsets[b + 1];
+            std::vector<std::pair<uint64_t, uint32_t>> builds;
+            builds.reserve(end - begin);
+            for (size_t i = begin; i < end; i++) {
+                builds.push_back({ store.masks[i], store.multipliers[i] });
+            }
+            std::sort(builds.begin(), builds.end());
+            if (deduplicate) {
+                builds.erase(std::unique(builds.begin(), builds.end(), [](const auto& a, const auto& b) {
+                    return a.first == b.first;
+                    }), builds.end());
+            }
+            for (size_t i = 0; i < builds.size(); i++) {
+                store.masks[begin + i] = builds[i].first;
+                store.multipliers[begin + i] = builds[i].second;
+            }
+            budgetSizes[b] = builds.size();
+        }
+        //close the gaps that deduplication left in the arena
+        size_t offset = 0;
+        for (int b = 0; b < store.talentPoints; b++) {
+            size_t begin = store.budgetOffsets[b];
+            std::copy(store.masks.begin() + begin, store.masks.begin() + begin + budgetSizes[b], store.masks.begin() + offset);
+            std::copy(store.multipliers.begin() + begin, store.multipliers.begin() + begin + budgetSizes[b], store.multipliers.begin() + offset);
+            store.budgetOffsets[b] = offset;
+            offset += budgetSizes[b];
+        }
+        store.budgetOffsets[store.talentPoints] = offset;
+        store.masks.resize(offset);
+        store.multipliers.resize(offset);
+        if (deduplicate) {
+            store.masks.shrink_to_fit();
+            store.multipliers.shrink_to_fit();
+        }
+        store.sorted = true;
+        store.deduplicated = store.deduplicated || deduplicate;
+    }
+
+    /*
+    Helper function that checks the talent points and returns the arena range of the budget.
+    */
+    std::pair<size_t, size_t> getBudgetRange(const BuildStore& store, int talentPoints) {
+        if (talentPoints < 1 || talentPoints > store.talentPoints)
+            throw std::invalid_argument("Store has no builds for " + std::to_string(talentPoints) + " talent points");
+        return { store.budgetOffsets[talentPoints - 1], store.budgetOffsets[talentPoints] };
+    }
+
+    size_t getBuildCount(const BuildStore& store, int talentPoints) {
+        auto range = getBudgetRange(store, talentPoints);
+        return range.second - range.first;
+    }
+
+    /*
+    Number of builds incl. switch talent choices (same as allCombinations of the counters).
+    */
+    int64_t getWeightedBuildCount(const BuildStore& store, int talentPoints) {
+        auto range = getBudgetRange(store, talentPoints);
+        int64_t count = 0;
+        for (size_t i = range.first; i < range.second; i++) {
+            count += store.multipliers[i];
+        }
+        return count;
+    }
+
+    std::span<const uint64_t> getBudgetMasks(const BuildStore& store, int talentPoints) {
+        auto range = getBudgetRange(store, talentPoints);
+        return std::span<const uint64_t>(store.masks.data() + range.first, range.second - range.first);
+    }
+
+    std::span<const uint32_t> getBudgetMultipliers(const BuildStore& store, int talentPoints) {
+        auto range = getBudgetRange(store, talentPoints);
+        return std::span<const uint32_t>(store.multipliers.data() + range.first, range.second - range.first);
+    }
+
+    /*
+    Binary search for sorted stores, linear scan otherwise.
+    */
+    bool containsBuild(const BuildStore& store, int talentPoints, uint64_t mask) {
+        std::span<const uint64_t> masks = getBudgetMasks(store, talentPoints);
+        if (store.sorted)
+            return std::binary_search(masks.begin(), masks.end(), mask);
+        return std::find(masks.begin(), masks.end(), mask) != masks.end();
+    }
+
+    /*
+    Allocated memory of the store in bytes.
+    */
+    size_t getBuildStoreBytes(const BuildStore& store) {
+        return store.masks.capacity() * sizeof(uint64_t) + store.multipliers.capacity() * sizeof(uint32_t) + store.budgetOffsets.capacity() * sizeof(size_t);
+    }
+}
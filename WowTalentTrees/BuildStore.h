@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <bitset>
+#include <span>
+#include <cstdint>
+
+#include "ShardedCounter.h"
+
+namespace WowTalentTrees {
+    /*
+    Columnar container for the results of the counters. std::pair<std::bitset<128>, int> needs 32 bytes per build (incl. padding), the store needs 12:
+    one column of uint64 indices and one column of multipliers (product of the choice counts of all selected switch talents, see createSortedMinimalDAG). All budgets (1 up to talentPoints talent points)
+    are stored back to back in a single arena, budget b is the range [budgetOffsets[b - 1], budgetOffsets[b]).
+    Sorted stores are sorted by index within every budget, deduplicated stores additionally contain every build only once.
+    */
+    struct BuildStore {
+        int talentPoints = 0;
+        bool sorted = false;
+        bool deduplicated = false;
+        std::vector<uint64_t> masks;
+        std::vector<uint32_t> multipliers;
+        std::vector<size_t> budgetOffsets;
+    };
+
+    BuildStore createBuildStore(std::vector<std::pair<std::bitset<128>, int>> combinations, int talentPoints);
+    BuildStore createBuildStore(std::vector<std::vector<std::pair<std::bitset<128>, int>>> combinations);
+    BuildStore createBuildStore(std::vector<std::vector<std::vector<std::pair<std::bitset<128>, int>>>> threadCombinations);
+    BuildStore createBuildStore(ShardResult shard);
+    void sortBuildStore(BuildStore& store, bool deduplicate);
+    size_t getBuildCount(const BuildStore& store, int talentPoints);
+    int64_t getWeightedBuildCount(const BuildStore& store, int talentPoints);
+    std::span<const uint64_t> getBudgetMasks(const BuildStore& store, int talentPoints);
+    std::span<const uint32_t> getBudgetMultipliers(const BuildStore& store, int talentPoints);
+    bool containsBuild(const BuildStore& store, int talentPoints, uint64_t mask);
+    size_t getBuildStoreBytes(const BuildStore& store);
+}
@@ -0,0 +1,236 @@
+#include "BuildValidator.h"
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <random>
+#include <chrono>
+#include <bit>
+
+namespace WowTalentTrees {
+    /*
+    Compiles the legality rules of a sorted DAG, uint64 indices of the validator are the same as the ones of the DAG.
+    */
+    BuildValidator createBuildValidator(const TreeDAGInfo& sortedTreeDAG) {
+        if (sortedTreeDAG.sortedTalents.size() > 64)
+            throw std::logic_error("Number of talents exceeds 64, need different indexing type instead of uint64");
+        BuildValidator validator;
+        validator.talentCount = static_cast<int>(sortedTreeDAG.sortedTalents.size());
+        validator.talentMask = validator.talentCount == 64 ? ~0ULL : (1ULL << validator.talentCount) - 1;
+        validator.childTable.resize(8 * 256, 0);
+        for (int i = 0; i < validator.talentCount; i++) {
+            uint64_t childMask = 0;
+            for (int j = 1; j < sortedTreeDAG.minimalTreeDAG[i].size(); j++) {
+                childMask |= 1ULL << sortedTreeDAG.minimalTreeDAG[i][j];
+            }
+            validator.childMasks.push_back(childMask);
+            validator.pointsRequired.push_back(sortedTreeDAG.sortedTalents[i]->pointsRequired);
+            for (int value = 0; value < 256; value++) {
+                if (value & (1 << (i % 8))) {
+                    validator.childTable[(i / 8) * 256 + value] |= childMask;
+                }
+            }
+        }
+        validator.rootMask = validator.talentMask;
+        for (auto& childMask : validator.childMasks) {
+            validator.rootMask &= ~childMask;
+        }
+
+        for (int i = 0; i < validator.talentCount; i++) {
+            if (validator.pointsRequired[i] > 0) {
+                validator.gatedTalents.push_back(i);
+                validator.gateThresholds.push_back(validator.pointsRequired[i]);
+            }
+        }
+        //same fields as the concrete builds of the enumeration
+        ChoiceLayout layout = createChoiceLayout(sortedTreeDAG);
+        validator.choiceTalents = layout.choiceTalents;
+        validator.choiceFieldMasks = layout.fieldMasks;
+        validator.lastChoices = layout.lastChoices;
+        for (uint64_t fieldMask : layout.fieldMasks) {
+            validator.choiceSuffixMask |= fieldMask;
+        }
+        return validator;
+    }
+
+    /*
+    Creates the validator for a (not expanded) tree.
+    */
+    BuildValidator createBuildValidator(TalentTree tree) {
+        expandTreeTalents(tree);
+        TreeDAGInfo sortedTreeDAG = createSortedMinimalDAG(tree);
+        return createBuildValidator(sortedTreeDAG);
+    }
+
+    /*
+    Helper function that ORs the table entries of all 8 bytes of the mask.
+    */
+    inline uint64_t lookupByteTable(const uint64_t* table, uint64_t mask) {
+        uint64_t result = 0;
+        for (int byte = 0; byte < 8; byte++) {
+            result |= table[byte * 256 + ((mask >> (8 * byte)) & 0xFF)];
+        }
+        return result;
+    }
+
+    /*
+    Core function of the bulk validation. Checks up to buildValidatorBlockSize builds rule by rule, every inner loop is branch free over the builds
+    of the block so the compiler can vectorize it (AVX2 / NEON depending on the target), no intrinsics needed.
+    Parent check: a talent has a selected parent iff it is a child of any selected talent, the children of all selected talents are 8 table lookups.
+    */
+    void validateBlock(
+        const BuildValidator& validator,
+        const uint64_t* masks,
+        const uint64_t* choices,
+        uint8_t* violations,
+        int count,
+        int talentPoints
+    ) {
+        //flags are collected in a local array, stores through uint8_t* may alias everything and would prevent vectorization
+        uint64_t reachable[buildValidatorBlockSize];
+        uint32_t flags[buildValidatorBlockSize];
+        const uint64_t* childTable = validator.childTable.data();
+        for (int b = 0; b < count; b++) {
+            reachable[b] = lookupByteTable(childTable, masks[b]) | validator.rootMask;
+        }
+        const uint64_t unknownMask = ~validator.talentMask;
+        for (int b = 0; b < count; b++) {
+            flags[b] = ((masks[b] & ~reachable[b]) != 0) * buildViolationMissingParent
+                | ((masks[b] & unknownMask) != 0) * buildViolationUnknownTalent;
+        }
+        const int gateCount = static_cast<int>(validator.gatedTalents.size());
+        for (int g = 0; g < gateCount; g++) {
+            const uint64_t talentBit = 1ULL << validator.gatedTalents[g];
+            const uint64_t lowerMask = talentBit - 1;
+            const int threshold = validator.gateThresholds[g];
+            for (int b = 0; b < count; b++) {
+                flags[b] |= (((masks[b] & talentBit) != 0) & (std::popcount(masks[b] & lowerMask) < threshold)) * buildViolationGate;
+            }
+        }
+        if (talentPoints > 0) {
+            for (int b = 0; b < count; b++) {
+                flags[b] |= (std::popcount(masks[b]) != talentPoints) * buildViolationTalentPoints;
+            }
+        }
+        if (choices != nullptr) {
+            const uint64_t unusedBits = ~validator.choiceSuffixMask;
+            for (int b = 0; b < count; b++) {
+                flags[b] |= ((choices[b] & unusedBits) != 0) * buildViolationChoice;
+            }
+            const int choiceCount = static_cast<int>(validator.choiceTalents.size());
+            for (int c = 0; c < choiceCount; c++) {
+                const uint64_t talentBit = 1ULL << validator.choiceTalents[c];
+                const uint64_t fieldMask = validator.choiceFieldMasks[c];
+                const uint64_t lastChoice = validator.lastChoices[c];
+                for (int b = 0; b < count; b++) {
+                    //a choice past the last one, or any choice of an unselected talent
+                    uint64_t field = choices[b] & fieldMask;
+                    flags[b] |= ((field > lastChoice) | (((masks[b] & talentBit) == 0) & (field != 0))) * buildViolationChoice;
+                }
+            }
+        }
+        for (int b = 0; b < count; b++) {
+            violations[b] = static_cast<uint8_t>(flags[b]);
+        }
+    }
+
+    /*
+    Checks a single build (talentPoints = 0 accepts any number of selected talents). Choices are not checked.
+    */
+    uint8_t validateBuild(const BuildValidator& validator, uint64_t mask, int talentPoints) {
+        uint8_t violations = 0;
+        validateBlock(validator, &mask, nullptr, &violations, 1, talentPoints);
+        return violations;
+    }
+
+    uint8_t validateBuild(const BuildValidator& validator, uint64_t mask, uint64_t choices, int talentPoints) {
+        uint8_t violations = 0;
+        validateBlock(validator, &mask, &choices, &violations, 1, talentPoints);
+        return violations;
+    }
+
+    /*
+    Checks all builds in parallel (blocks of buildValidatorBlockSize builds). choices is either empty (choices are not checked) or has the same size as masks.
+    */
+    void validateBuilds(
+        const BuildValidator& validator,
+        std::span<const uint64_t> masks,
+        std::span<const uint64_t> choices,
+        std::span<uint8_t> violations,
+        int talentPoints
+    ) {
+        if (violations.size() != masks.size())
+            throw std::invalid_argument("Number of violations and masks differ");
+        if (choices.size() > 0 && choices.size() != masks.size())
+            throw std::invalid_argument("Number of choices and masks differ");
+        int64_t blockCount = (static_cast<int64_t>(masks.size()) + buildValidatorBlockSize - 1) / buildValidatorBlockSize;
+#pragma omp parallel for schedule(static)
+        for (int64_t block = 0; block < blockCount; block++) {
+            size_t begin = block * buildValidatorBlockSize;
+            int count = static_cast<int>(std::min<size_t>(buildValidatorBlockSize, masks.size() - begin));
+            validateBlock(validator, masks.data() + begin, choices.size() > 0 ? choices.data() + begin : nullptr, violations.data() + begin, count, talentPoints);
+        }
+    }
+
+    std::vector<uint8_t> validateBuilds(const BuildValidator& validator, const std::vector<uint64_t>& masks, int talentPoints) {
+        std::vector<uint8_t> violations(masks.size());
+        validateBuilds(validator, masks, std::span<const uint64_t>(), violations, talentPoints);
+        return violations;
+    }
+
+    size_t countLegalBuilds(const std::vector<uint8_t>& violations) {
+        return std::count(violations.begin(), violations.end(), static_cast<uint8_t>(0));
+    }
+
+    /*
+    Measures the bulk validation speed on the default tree: half of the builds are enumerated ones, the other half are enumerated builds with one talent
+    moved to a random position. Cross-checks the result against the enumeration (a build with the right number of talents is legal iff it was enumerated).
+    */
+    void buildValidatorThroughput(int points, size_t buildCount) {
+        TalentTree tree = getDefaultTree();
+        tree.unspentTalentPoints = points;
+        std::vector<std::pair<std::bitset<128>, int>> combinations = countConfigurationsFast(tree);
+        if (combinations.size() == 0)
+            throw std::invalid_argument("No builds for " + std::to_string(points) + " talent points");
+        std::vector<uint64_t> enumerated;
+        enumerated.reserve(combinations.size());
+        for (auto& comb : combinations) {
+            enumerated.push_back(comb.first.to_ullong());
+        }
+        std::sort(enumerated.begin(), enumerated.end());
+        BuildValidator validator = createBuildValidator(getDefaultTree());
+
+        std::mt19937_64 rng(0);
+        std::vector<uint64_t> masks(buildCount);
+        for (size_t i = 0; i < buildCount; i++) {
+            uint64_t mask = enumerated[rng() % enumerated.size()];
+            if (i % 2 == 1) {
+                uint64_t setBits = mask;
+                for (uint64_t skip = rng() % std::popcount(mask); skip > 0; skip--) {
+                    setBits &= setBits - 1;
+                }
+                uint64_t unsetBits = ~mask & validator.talentMask;
+                for (uint64_t skip = rng() % std::popcount(unsetBits); skip > 0; skip--) {
+                    unsetBits &= unsetBits - 1;
+                }
+                mask ^= (setBits & (~setBits + 1)) | (unsetBits & (~unsetBits + 1));
+            }
+            masks[i] = mask;
+        }
+
+        std::vector<uint8_t> violations(buildCount);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        validateBuilds(validator, masks, std::span<const uint64_t>(), violations, points);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> ms_double = t2 - t1;
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < buildCount; i++) {
+            if ((violations[i] == 0) != std::binary_search(enumerated.begin(), enumerated.end(), masks[i])) {
+                mismatches++;
+            }
+        }
+        std::cout << "Validated " << buildCount << " builds (" << countLegalBuilds(violations) << " legal) in " << ms_double.count() << " ms, "
+            << buildCount / ms_double.count() / 1000.0 << " M builds/s, mismatches with enumeration: " << mismatches << std::endl;
+    }
+}
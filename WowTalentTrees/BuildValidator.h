@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+#include "WowTalentTrees.h"
+#include "ChoiceExpansion.h"
+
+namespace WowTalentTrees {
+    //violation flags of a build, 0 means the build is legal
+    constexpr uint8_t buildViolationMissingParent = 1;
+    constexpr uint8_t buildViolationGate = 2;
+    constexpr uint8_t buildViolationChoice = 4;
+    constexpr uint8_t buildViolationTalentPoints = 8;
+    constexpr uint8_t buildViolationUnknownTalent = 16;
+
+    //number of builds that are checked rule by rule together, small enough to keep the block in L1
+    constexpr int buildValidatorBlockSize = 256;
+
+    /*
+    Legality rules of a tree compiled to bit masks in the uint64 index space of the sorted DAG (see TreeDAGInfo). A build is legal iff it can be
+    produced by visitTalent: every selected talent has a selected parent (or is a root) and at least pointsRequired talents with lower indices are selected.
+    The parent check uses 8 byte lookup tables that OR the children of all selected talents, gated talents are checked one by one.
+    Builds optionally come with the choice suffix of their concrete build (see ChoiceLayout): the field of a selected choice talent has to be a valid
+    choice (less than its number of choices), the field of an unselected one and all bits outside the fields have to be 0.
+    */
+    struct BuildValidator {
+        int talentCount = 0;
+        uint64_t talentMask = 0;
+        uint64_t rootMask = 0;
+        std::vector<uint64_t> childMasks;
+        std::vector<int> pointsRequired;
+        //[byte * 256 + value]: children of all talents selected in this byte of the mask
+        std::vector<uint64_t> childTable;
+        std::vector<int> gatedTalents;
+        std::vector<int> gateThresholds;
+        //per choice talent of the ChoiceLayout: field mask and value of the last choice
+        std::vector<int> choiceTalents;
+        std::vector<uint64_t> choiceFieldMasks;
+        std::vector<uint64_t> lastChoices;
+        uint64_t choiceSuffixMask = 0;
+    };
+
+    BuildValidator createBuildValidator(const TreeDAGInfo& sortedTreeDAG);
+    BuildValidator createBuildValidator(TalentTree tree);
+    uint8_t validateBuild(const BuildValidator& validator, uint64_t mask, int talentPoints = 0);
+    uint8_t validateBuild(const BuildValidator& validator, uint64_t mask, uint64_t choices, int talentPoints = 0);
+    void validateBuilds(
+        const BuildValidator& validator,
+        std::span<const uint64_t> masks,
+        std::span<const uint64_t> choices,
+        std::span<uint8_t> violations,
+        int talentPoints = 0
+    );
+    std::vector<uint8_t> validateBuilds(const BuildValidator& validator, const std::vector<uint64_t>& masks, int talentPoints = 0);
+    size_t countLegalBuilds(const std::vector<uint8_t>& violations);
+    void buildValidatorThroughput(int points, size_t buildCount);
+}
@@ -0,0 +1,153 @@
+#include "ChoiceExpansion.h"
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+
+namespace WowTalentTrees {
+    /*
+    Creates the choice layout for a sorted DAG, base masks of the layout are the same as the uint64 indices of the DAG.
+    */
+    ChoiceLayout createChoiceLayout(const TreeDAGInfo& sortedTreeDAG) {
+        if (sortedTreeDAG.sortedTalents.size() > 64)
+            throw std::logic_error("Number of talents exceeds 64, need different indexing type instead of uint64");
+        ChoiceLayout layout;
+        layout.talentCount = static_cast<int>(sortedTreeDAG.sortedTalents.size());
+        layout.rootIndices = sortedTreeDAG.rootIndices;
+        layout.talentToChoice.resize(layout.talentCount, -1);
+        for (int i = 0; i < layout.talentCount; i++) {
+            uint64_t childMask = 0;
+            for (int j = 1; j < sortedTreeDAG.minimalTreeDAG[i].size(); j++) {
+                childMask |= 1ULL << sortedTreeDAG.minimalTreeDAG[i][j];
+            }
+            layout.childMasks.push_back(childMask);
+            layout.pointsRequired.push_back(sortedTreeDAG.sortedTalents[i]->pointsRequired);
+
+            int choices = sortedTreeDAG.minimalTreeDAG[i][0];
+            if (choices < 2)
+                continue;
+            int bits = std::bit_width(static_cast<unsigned int>(choices - 1));
+            if (layout.suffixBits + bits > 64)
+                throw std::logic_error("Choice fields exceed 64 bits, choices do not fit into uint64");
+            layout.talentToChoice[i] = static_cast<int>(layout.choiceTalents.size());
+            layout.choiceTalentMask |= 1ULL << i;
+            layout.choiceTalents.push_back(i);
+            layout.choiceCounts.push_back(choices);
+            layout.fieldOnes.push_back(1ULL << layout.suffixBits);
+            layout.fieldMasks.push_back(((1ULL << bits) - 1) << layout.suffixBits);
+            layout.lastChoices.push_back(static_cast<uint64_t>(choices - 1) << layout.suffixBits);
+            layout.suffixBits += bits;
+        }
+        return layout;
+    }
+
+    /*
+    Creates the choice layout for a (not expanded) tree.
+    */
+    ChoiceLayout createChoiceLayout(TalentTree tree) {
+        expandTreeTalents(tree);
+        TreeDAGInfo sortedTreeDAG = createSortedMinimalDAG(tree);
+        return createChoiceLayout(sortedTreeDAG);
+    }
+
+    /*
+    Number of concrete builds of a base mask (same as the multiplier of the counters).
+    */
+    uint64_t getChoiceVariantCount(const ChoiceLayout& layout, uint64_t mask) {
+        uint64_t count = 1;
+        uint64_t selected = mask & layout.choiceTalentMask;
+        while (selected) {
+            uint64_t choices = layout.choiceCounts[layout.talentToChoice[std::countr_zero(selected)]];
+            selected &= selected - 1;
+            if (count > ~0ULL / choices)
+                throw std::overflow_error("Number of concrete builds does not fit into 64 bit");
+            count *= choices;
+        }
+        return count;
+    }
+
+    /*
+    Random access version of the expansion: the variant-th concrete build of a base mask in the same order as nextChoiceBuild.
+    */
+    ChoiceBuild getChoiceBuild(const ChoiceLayout& layout, uint64_t mask, uint64_t variant) {
+        if (variant >= getChoiceVariantCount(layout, mask))
+            throw std::invalid_argument("Build has only " + std::to_string(getChoiceVariantCount(layout, mask)) + " variants");
+        ChoiceBuild build{ mask, 0 };
+        uint64_t selected = mask & layout.choiceTalentMask;
+        while (selected) {
+            int c = layout.talentToChoice[std::countr_zero(selected)];
+            selected &= selected - 1;
+            build.choices += (variant % layout.choiceCounts[c]) * layout.fieldOnes[c];
+            variant /= layout.choiceCounts[c];
+        }
+        return build;
+    }
+
+    /*
+    Selected choice of a talent in a concrete build, -1 if the talent is no choice talent or not selected.
+    */
+    int getChoice(const ChoiceLayout& layout, const ChoiceBuild& build, int talentIndex) {
+        if (talentIndex < 0 || talentIndex >= layout.talentCount)
+            throw std::invalid_argument("Talent index " + std::to_string(talentIndex) + " is out of range");
+        int c = layout.talentToChoice[talentIndex];
+        if (c < 0 || !(build.mask & (1ULL << talentIndex)))
+            return -1;
+        return static_cast<int>((build.choices & layout.fieldMasks[c]) / layout.fieldOnes[c]);
+    }
+
+    /*
+    Concrete build as a single 128 bit id (same type as the counter results): base mask in the lower, choice suffix in the upper 64 bits.
+    */
+    std::bitset<128> getChoiceBuildId(const ChoiceBuild& build) {
+        return (std::bitset<128>(build.choices) << 64) | std::bitset<128>(build.mask);
+    }
+
+    /*
+    Expands the results of a counter into all concrete builds in parallel. The multipliers of the counter are the number of variants of every build,
+    so every base build gets its output range up front.
+    */
+    std::vector<ChoiceBuild> expandChoiceBuilds(const ChoiceLayout& layout, const std::vector<std::pair<std::bitset<128>, int>>& combinations) {
+        std::vector<size_t> offsets(combinations.size() + 1, 0);
+        for (int i = 0; i < combinations.size(); i++) {
+            offsets[i + 1] = offsets[i] + static_cast<size_t>(combinations[i].second);
+        }
+        std::vector<ChoiceBuild> builds(offsets.back());
+        //exceptions can't leave the parallel section
+        bool mismatch = false;
+        int64_t combinationCount = static_cast<int64_t>(combinations.size());
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int64_t i = 0; i < combinationCount; i++) {
+            ChoiceExpansion expansion = beginChoiceExpansion(layout, combinations[i].first.to_ullong());
+            size_t position = offsets[i];
+            ChoiceBuild build;
+            while (nextChoiceBuild(layout, expansion, build) && position < offsets[i + 1]) {
+                builds[position++] = build;
+            }
+            if (position != offsets[i + 1] || !expansion.finished) {
+#pragma omp atomic write
+                mismatch = true;
+            }
+        }
+        if (mismatch)
+            throw std::logic_error("Multiplier of a build does not match its number of choice variants");
+        return builds;
+    }
+
+    /*
+    Enumerates all concrete builds of the default tree with the given number of talent points (same number as the counts incl. switch talents).
+    */
+    void choiceExpansionCount(int points) {
+        ChoiceLayout layout = createChoiceLayout(getDefaultTree());
+        size_t buildCount = 0;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        enumerateChoiceBuilds(layout, points, [&buildCount](const ChoiceBuild&) {
+            buildCount++;
+        });
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> ms_double = t2 - t1;
+        std::cout << "Number of concrete builds for " << points << " talent points: " << buildCount << " (" << layout.choiceTalents.size()
+            << " choice talents, " << layout.suffixBits << " suffix bits)" << std::endl;
+        std::cout << "Choice expansion operation time: " << ms_double.count() << " ms" << std::endl;
+    }
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <vector>
+#include <bitset>
+#include <cstdint>
+#include <bit>
+
+#include "WowTalentTrees.h"
+
+namespace WowTalentTrees {
+    /*
+    Layout of the concrete (choice resolved) builds of a tree. The counters only multiply the count of a build with the number of choices of every selected
+    switch talent (see createSortedMinimalDAG), a concrete build id is the base uint64 index (mask) plus a choice suffix. Every talent of the sorted DAG with more
+    than one choice has a fixed bit field of ceil(log2(choices)) bits in the suffix, the field holds the selected choice (0 for unselected talents).
+    Expanding a base mask into all its concrete builds is an odometer over the fields of its selected choice talents (first choice talent counts fastest).
+    Also holds the bit mask version of the sorted DAG for enumerateChoiceBuilds.
+    */
+    struct ChoiceLayout {
+        int talentCount = 0;
+        uint64_t choiceTalentMask = 0;
+        std::vector<int> choiceTalents;
+        std::vector<int> choiceCounts;
+        //per sorted DAG index: position in choiceTalents or -1
+        std::vector<int> talentToChoice;
+        //per choice talent: lowest bit of the field, field mask and value of the last choice
+        std::vector<uint64_t> fieldOnes;
+        std::vector<uint64_t> fieldMasks;
+        std::vector<uint64_t> lastChoices;
+        int suffixBits = 0;
+        std::vector<uint64_t> childMasks;
+        std::vector<int> pointsRequired;
+        std::vector<int> rootIndices;
+    };
+
+    struct ChoiceBuild {
+        uint64_t mask = 0;
+        uint64_t choices = 0;
+    };
+
+    /*
+    State of the lazy expansion of a single base mask, see beginChoiceExpansion/nextChoiceBuild.
+    */
+    struct ChoiceExpansion {
+        uint64_t mask = 0;
+        uint64_t selectedChoiceTalents = 0;
+        uint64_t choices = 0;
+        bool finished = false;
+    };
+
+    ChoiceLayout createChoiceLayout(const TreeDAGInfo& sortedTreeDAG);
+    ChoiceLayout createChoiceLayout(TalentTree tree);
+    uint64_t getChoiceVariantCount(const ChoiceLayout& layout, uint64_t mask);
+    ChoiceBuild getChoiceBuild(const ChoiceLayout& layout, uint64_t mask, uint64_t variant);
+    int getChoice(const ChoiceLayout& layout, const ChoiceBuild& build, int talentIndex);
+    std::bitset<128> getChoiceBuildId(const ChoiceBuild& build);
+    std::vector<ChoiceBuild> expandChoiceBuilds(const ChoiceLayout& layout, const std::vector<std::pair<std::bitset<128>, int>>& combinations);
+
+    inline ChoiceExpansion beginChoiceExpansion(const ChoiceLayout& layout, uint64_t mask) {
+        return { mask, mask & layout.choiceTalentMask, 0, false };
+    }
+
+    /*
+    Writes the next concrete build of the expansion into build, returns false after the last one. Advancing the odometer is an add or a clear per field.
+    */
+    inline bool nextChoiceBuild(const ChoiceLayout& layout, ChoiceExpansion& expansion, ChoiceBuild& build) {
+        if (expansion.finished)
+            return false;
+        build.mask = expansion.mask;
+        build.choices = expansion.choices;
+        uint64_t selected = expansion.selectedChoiceTalents;
+        while (selected) {
+            int c = layout.talentToChoice[std::countr_zero(selected)];
+            selected &= selected - 1;
+            if ((expansion.choices & layout.fieldMasks[c]) != layout.lastChoices[c]) {
+                expansion.choices += layout.fieldOnes[c];
+                return true;
+            }
+            expansion.choices &= ~layout.fieldMasks[c];
+        }
+        expansion.finished = true;
+        return true;
+    }
+
+    /*
+    Same search as visitTalent, completed base builds are expanded lazily into their concrete builds which are passed to the visitor one by one.
+    */
+    template<typename Visitor>
+    void visitTalentChoices(
+        const ChoiceLayout& layout,
+        int talentIndex,
+        uint64_t visitedTalents,
+        uint64_t possibleTalents,
+        int talentPointsSpent,
+        int talentPointsLeft,
+        Visitor& visitor
+    ) {
+        visitedTalents |= 1ULL << talentIndex;
+        talentPointsSpent += 1;
+        talentPointsLeft -= 1;
+        if (talentPointsLeft == 0) {
+            ChoiceExpansion expansion = beginChoiceExpansion(layout, visitedTalents);
+            ChoiceBuild build;
+            while (nextChoiceBuild(layout, expansion, build)) {
+                visitor(build);
+            }
+            return;
+        }
+        if (layout.talentCount - talentIndex - 1 < talentPointsLeft)
+            return;
+        possibleTalents |= layout.childMasks[talentIndex];
+        uint64_t nextTalents = talentIndex == 63 ? 0 : possibleTalents & (~0ULL << (talentIndex + 1));
+        while (nextTalents) {
+            int nextTalent = std::countr_zero(nextTalents);
+            nextTalents &= nextTalents - 1;
+            if (talentPointsSpent >= layout.pointsRequired[nextTalent]) {
+                visitTalentChoices(layout, nextTalent, visitedTalents, possibleTalents, talentPointsSpent, talentPointsLeft, visitor);
+            }
+        }
+    }
+
+    /*
+    Enumerates all concrete builds with the given number of talent points without storing them.
+    */
+    template<typename Visitor>
+    void enumerateChoiceBuilds(const ChoiceLayout& layout, int talentPoints, Visitor visitor) {
+        if (talentPoints < 1)
+            return;
+        uint64_t rootMask = 0;
+        for (int root : layout.rootIndices) {
+            rootMask |= 1ULL << root;
+        }
+        for (int root : layout.rootIndices) {
+            if (layout.pointsRequired[root] == 0) {
+                visitTalentChoices(layout, root, 0, rootMask, 0, talentPoints, visitor);
+            }
+        }
+    }
+
+    void choiceExpansionCount(int points);
+}
@@ -0,0 +1,411 @@
+#include "DifferentialHarness.h"
+#include "BuildDecoder.h"
+#include "TreeGenerator.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <stdexcept>
+
+namespace WowTalentTrees {
+    /*
+    Helper function that transforms the combinations of the fast counters into sorted (mask, weight) pairs. Duplicates are kept on purpose,
+    a counter that emits a build twice is wrong.
+    */
+    std::vector<std::pair<uint64_t, int64_t>> getSortedBuilds(const std::vector<const std::vector<std::pair<std::bitset<128>, int>>*>& combinations) {
+        std::vector<std::pair<uint64_t, int64_t>> builds;
+        for (auto& part : combinations) {
+            for (auto& comb : *part) {
+                builds.push_back({ comb.first.to_ullong(), comb.second });
+            }
+        }
+        std::sort(builds.begin(), builds.end());
+        return builds;
+    }
+
+    /*
+    Order independent hash of a build set (sum of mixed masks, splitmix64 finalizer), used to compare result sets that are too large to keep around.
+    */
+    uint64_t getBuildSetHash(const std::vector<std::pair<uint64_t, int64_t>>& builds) {
+        uint64_t hash = 0;
+        for (auto& build : builds) {
+            uint64_t z = build.first + 0x9E3779B97F4A7C15ULL;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            hash += z ^ (z >> 31);
+        }
+        return hash;
+    }
+
+    /*
+    Helper function that fills the counts of an engine result from its builds.
+    */
+    void setEngineCounts(EngineResult& result, bool hasWeights) {
+        result.buildCount = result.builds.size();
+        if (hasWeights) {
+            result.weightedCount = 0;
+            for (auto& build : result.builds) {
+                result.weightedCount += build.second;
+            }
+        }
+        result.setHash = getBuildSetHash(result.builds);
+    }
+
+    /*
+    Creates the talents of the bloodmallet counter for a (not expanded) tree. Multi point talents become rank chains ("INDEX1", "INDEX2", ...) and switch talents
+    become choice siblings ("INDEXa", "INDEXb", ... one per choice). expandedIndices holds the index of the talent in the expanded tree (see expandTalentAndAdvance) for every
+    created talent, which translates bloodmallet paths into the uint64 index space.
+    NOTE: bloodmallet resolves parent names by substring search, parents are therefore always referenced by their full (last rank/choice) name.
+    */
+    std::vector<std::shared_ptr<bloodmallet::Talent>> createBloodmalletTalents(TalentTree tree, std::vector<std::string>& expandedIndices) {
+        std::vector<std::shared_ptr<Talent>> talents;
+        std::unordered_set<std::shared_ptr<Talent>> visited;
+        std::deque<std::shared_ptr<Talent>> queue(tree.talentRoots.begin(), tree.talentRoots.end());
+        while (queue.size() > 0) {
+            std::shared_ptr<Talent> talent = queue.front();
+            queue.pop_front();
+            if (visited.count(talent))
+                continue;
+            visited.insert(talent);
+            talents.push_back(talent);
+            for (auto& child : talent->children) {
+                queue.push_back(child);
+            }
+        }
+
+        std::vector<std::shared_ptr<bloodmallet::Talent>> bloodmalletTalents;
+        expandedIndices.clear();
+        for (auto& talent : talents) {
+            std::vector<std::string> parentNames;
+            for (auto& parent : talent->parents) {
+                if (parent->type == TalentType::SWITCH) {
+                    for (int c = 0; c < parent->choiceCount; c++) {
+                        parentNames.push_back(parent->index + static_cast<char>('a' + c));
+                    }
+                }
+                else if (parent->maxPoints > 1) {
+                    parentNames.push_back(parent->index + std::to_string(parent->maxPoints));
+                }
+                else {
+                    parentNames.push_back(parent->index);
+                }
+            }
+            if (talent->type == TalentType::SWITCH) {
+                for (int c = 0; c < talent->choiceCount; c++) {
+                    std::vector<std::string> otherChoices;
+                    for (int o = 0; o < talent->choiceCount; o++) {
+                        if (o != c) {
+                            otherChoices.push_back(talent->index + static_cast<char>('a' + o));
+                        }
+                    }
+                    bloodmalletTalents.push_back(bloodmallet::createTalent(talent->index + static_cast<char>('a' + c), bloodmallet::TalentType::CHOICE, talent->pointsRequired,
+                        parentNames, std::vector<std::string>(), otherChoices));
+                    expandedIndices.push_back(talent->index);
+                }
+            }
+            else if (talent->maxPoints > 1) {
+                for (int rank = 1; rank <= talent->maxPoints; rank++) {
+                    std::vector<std::string> rankParentNames = rank == 1 ? parentNames : std::vector<std::string>{ talent->index + std::to_string(rank - 1) };
+                    bloodmalletTalents.push_back(bloodmallet::createTalent(talent->index + std::to_string(rank), bloodmallet::TalentType::PASSIVE, talent->pointsRequired,
+                        rankParentNames, std::vector<std::string>(), std::vector<std::string>()));
+                    expandedIndices.push_back(talent->index + "_" + std::to_string(rank - 1));
+                }
+            }
+            else {
+                bloodmallet::TalentType type = talent->type == TalentType::ACTIVE ? bloodmallet::TalentType::ABILITY : bloodmallet::TalentType::PASSIVE;
+                bloodmalletTalents.push_back(bloodmallet::createTalent(talent->index, type, talent->pointsRequired,
+                    parentNames, std::vector<std::string>(), std::vector<std::string>()));
+                expandedIndices.push_back(talent->index);
+            }
+        }
+        return bloodmalletTalents;
+    }
+
+    /*
+    Runs all counting engines for the same tree and talent points and compares the resulting build sets with countConfigurationsFast as reference.
+    The legacy counter has no switch talent weights and ignores gates (skipped for trees with gates), all other engines are compared incl. weights.
+    Every engine gets a freshly parsed tree since the counters modify the (shared) talents.
+    */
+    DifferentialReport runDifferentialCheck(std::string treeRep, int talentPoints, const DifferentialSettings& settings) {
+        if (talentPoints < 1)
+            throw std::invalid_argument("Talent points have to be >= 1");
+        DifferentialReport report;
+        report.treeRep = treeRep;
+        report.talentPoints = talentPoints;
+        bool hasGates = treeRep.find("@") != std::string::npos;
+
+        TalentTree expandedTree = parseTree(treeRep);
+        expandTreeTalents(expandedTree);
+        TreeDAGInfo sortedTreeDAG = createSortedMinimalDAG(expandedTree);
+        std::unordered_map<std::string, int> indexToBit;
+        for (int i = 0; i < sortedTreeDAG.sortedTalents.size(); i++) {
+            indexToBit[sortedTreeDAG.sortedTalents[i]->index] = i;
+        }
+        BuildDecoder decoder = createBuildDecoder(parseTree(treeRep));
+
+        auto getTree = [&treeRep, talentPoints]() {
+            TalentTree tree = parseTree(treeRep);
+            tree.unspentTalentPoints = talentPoints;
+            return tree;
+        };
+        auto getMilliseconds = [](std::chrono::high_resolution_clock::time_point t1, std::chrono::high_resolution_clock::time_point t2) {
+            std::chrono::duration<double, std::milli> ms_double = t2 - t1;
+            return ms_double.count();
+        };
+
+        //reference engine
+        EngineResult fast;
+        fast.engine = "countConfigurationsFast";
+        auto t1 = std::chrono::high_resolution_clock::now();
+        std::vector<std::pair<std::bitset<128>, int>> fastCombinations = countConfigurationsFast(getTree());
+        auto t2 = std::chrono::high_resolution_clock::now();
+        fast.milliseconds = getMilliseconds(t1, t2);
+        fast.builds = getSortedBuilds({ &fastCombinations });
+        fastCombinations.clear();
+        setEngineCounts(fast, true);
+        report.hashMode = fast.buildCount > settings.hashThreshold;
+        report.engines.push_back(fast);
+        report.engines.back().builds.clear();
+        if (report.hashMode) {
+            fast.builds.clear();
+            fast.builds.shrink_to_fit();
+        }
+        //in hash mode the builds of an engine are dropped as soon as the counts and the hash are known
+        auto addResult = [&report](EngineResult& result) {
+            if (report.hashMode) {
+                result.builds.clear();
+                result.builds.shrink_to_fit();
+            }
+            report.engines.push_back(std::move(result));
+        };
+
+        {
+            EngineResult result;
+            result.engine = "countConfigurationsFastParallel";
+            t1 = std::chrono::high_resolution_clock::now();
+            std::vector<std::vector<std::pair<std::bitset<128>, int>>> combinations = countConfigurationsFastParallel(getTree());
+            t2 = std::chrono::high_resolution_clock::now();
+            result.milliseconds = getMilliseconds(t1, t2);
+            result.builds = getSortedBuilds({ &combinations[talentPoints - 1] });
+            setEngineCounts(result, true);
+            addResult(result);
+        }
+        {
+            EngineResult result;
+            result.engine = "countConfigurationsFastParallelThreaded";
+            t1 = std::chrono::high_resolution_clock::now();
+            std::vector<std::vector<std::vector<std::pair<std::bitset<128>, int>>>> combinations = countConfigurationsFastParallelThreaded(getTree());
+            t2 = std::chrono::high_resolution_clock::now();
+            result.milliseconds = getMilliseconds(t1, t2);
+            std::vector<const std::vector<std::pair<std::bitset<128>, int>>*> parts;
+            for (auto& threadCombinations : combinations) {
+                parts.push_back(&threadCombinations[talentPoints - 1]);
+            }
+            result.builds = getSortedBuilds(parts);
+            setEngineCounts(result, true);
+            addResult(result);
+        }
+        {
+            EngineResult result;
+            result.engine = "countConfigurations (legacy)";
+            if (hasGates) {
+                result.skipped = true;
+                result.note = "ignores gates (points required)";
+            }
+            else if (talentPoints > settings.maxLegacyPoints) {
+                result.skipped = true;
+                result.note = "talent points > " + std::to_string(settings.maxLegacyPoints);
+            }
+            else if (report.hashMode) {
+                result.skipped = true;
+                result.note = "legacy builds can only be compared with the reference builds (not available in hash mode)";
+            }
+            else {
+                t1 = std::chrono::high_resolution_clock::now();
+                std::unordered_set<std::string> configurations = countConfigurations(getTree());
+                t2 = std::chrono::high_resolution_clock::now();
+                result.milliseconds = getMilliseconds(t1, t2);
+                //legacy builds are talent strings, they are translated with the decoded reference builds, unknown strings can't be part of the reference
+                std::unordered_map<std::string, uint64_t> stringToMask;
+                for (auto& build : fast.builds) {
+                    stringToMask[decodeBuild(decoder, build.first)] = build.first;
+                }
+                size_t unknownBuilds = 0;
+                for (auto& configuration : configurations) {
+                    if (stringToMask.count(configuration)) {
+                        result.builds.push_back({ stringToMask[configuration], 0 });
+                    }
+                    else {
+                        unknownBuilds++;
+                        if (unknownBuilds <= settings.maxListedMismatches) {
+                            report.mismatches.push_back(result.engine + ": build not in reference " + configuration);
+                        }
+                    }
+                }
+                std::sort(result.builds.begin(), result.builds.end());
+                setEngineCounts(result, false);
+                result.buildCount += unknownBuilds;
+                if (unknownBuilds > 0) {
+                    result.note = std::to_string(unknownBuilds) + " builds not in reference";
+                    report.passed = false;
+                }
+            }
+            addResult(result);
+        }
+        {
+            EngineResult result;
+            result.engine = "bloodmallet::igrow";
+            if (talentPoints > settings.maxBloodmalletPoints) {
+                result.skipped = true;
+                result.note = "talent points > " + std::to_string(settings.maxBloodmalletPoints);
+            }
+            else {
+                std::vector<std::string> expandedIndices;
+                std::vector<std::shared_ptr<bloodmallet::Talent>> talents = createBloodmalletTalents(parseTree(treeRep), expandedIndices);
+                talents = bloodmallet::_talent_post_init(talents);
+                t1 = std::chrono::high_resolution_clock::now();
+                std::vector<std::vector<bool>> paths = bloodmallet::igrow(talents, talentPoints - 1);
+                t2 = std::chrono::high_resolution_clock::now();
+                result.milliseconds = getMilliseconds(t1, t2);
+                //both choices of a switch talent are the same uint64 index, merge them into the weight
+                std::vector<std::pair<uint64_t, int64_t>> builds;
+                builds.reserve(paths.size());
+                for (auto& path : paths) {
+                    uint64_t mask = 0;
+                    for (int i = 0; i < path.size(); i++) {
+                        if (path[i]) {
+                            mask |= 1ULL << indexToBit[expandedIndices[i]];
+                        }
+                    }
+                    builds.push_back({ mask, 1 });
+                }
+                std::sort(builds.begin(), builds.end());
+                for (auto& build : builds) {
+                    if (result.builds.size() > 0 && result.builds.back().first == build.first) {
+                        result.builds.back().second += 1;
+                    }
+                    else {
+                        result.builds.push_back(build);
+                    }
+                }
+                setEngineCounts(result, true);
+            }
+            addResult(result);
+        }
+
+        //compare with reference
+        for (int e = 1; e < report.engines.size(); e++) {
+            EngineResult& result = report.engines[e];
+            if (result.skipped)
+                continue;
+            const std::string& name = result.engine;
+            if (result.buildCount != fast.buildCount) {
+                report.mismatches.push_back(name + ": " + std::to_string(result.buildCount) + " builds instead of " + std::to_string(fast.buildCount));
+                report.passed = false;
+            }
+            if (result.weightedCount >= 0 && result.weightedCount != fast.weightedCount) {
+                report.mismatches.push_back(name + ": " + std::to_string(result.weightedCount) + " builds incl. switch talents instead of " + std::to_string(fast.weightedCount));
+                report.passed = false;
+            }
+            if (result.setHash != fast.setHash) {
+                report.mismatches.push_back(name + ": build set hash differs");
+                report.passed = false;
+            }
+            if (report.hashMode)
+                continue;
+            int listed = 0;
+            size_t i = 0;
+            size_t j = 0;
+            while ((i < fast.builds.size() || j < result.builds.size()) && listed < settings.maxListedMismatches) {
+                if (j == result.builds.size() || (i < fast.builds.size() && fast.builds[i].first < result.builds[j].first)) {
+                    report.mismatches.push_back(name + ": missing " + decodeBuild(decoder, fast.builds[i].first));
+                    listed++;
+                    i++;
+                }
+                else if (i == fast.builds.size() || result.builds[j].first < fast.builds[i].first) {
+                    report.mismatches.push_back(name + ": extra " + decodeBuild(decoder, result.builds[j].first));
+                    listed++;
+                    j++;
+                }
+                else {
+                    if (result.weightedCount >= 0 && result.builds[j].second != fast.builds[i].second) {
+                        report.mismatches.push_back(name + ": weight " + std::to_string(result.builds[j].second) + " instead of " + std::to_string(fast.builds[i].second)
+                            + " for " + decodeBuild(decoder, fast.builds[i].first));
+                        listed++;
+                    }
+                    i++;
+                    j++;
+                }
+            }
+            if (listed > 0) {
+                report.passed = false;
+            }
+        }
+        //builds are only needed for the comparison
+        for (auto& result : report.engines) {
+            result.builds.clear();
+            result.builds.shrink_to_fit();
+        }
+        return report;
+    }
+
+    void printDifferentialReport(const DifferentialReport& report) {
+        std::cout << "Differential check for " << report.talentPoints << " talent points" << (report.hashMode ? " (hash mode)" : "") << std::endl;
+        for (auto& result : report.engines) {
+            std::cout << result.engine << ": ";
+            if (result.skipped) {
+                std::cout << "skipped, " << result.note << std::endl;
+                continue;
+            }
+            std::cout << result.milliseconds << " ms, " << result.buildCount << " builds";
+            if (result.weightedCount >= 0) {
+                std::cout << ", " << result.weightedCount << " incl. switch talents";
+            }
+            std::cout << ", hash " << std::hex << result.setHash << std::dec;
+            if (result.note.size() > 0) {
+                std::cout << ", " << result.note;
+            }
+            std::cout << std::endl;
+        }
+        for (auto& mismatch : report.mismatches) {
+            std::cout << mismatch << std::endl;
+        }
+        std::cout << (report.passed ? "All engines agree." : "Engines disagree!") << std::endl;
+    }
+
+    /*
+    Command line mode: "check <points>" checks the default tree, "check <points> <seed> <nodeCount>" a synthetic tree (see TreeGenerator.h).
+    */
+    int runDifferentialCommand(int argc, char** argv) {
+        std::vector<std::string> args(argv + 1, argv + argc);
+        try {
+            if (args[0] == "check" && (args.size() == 2 || args.size() == 4)) {
+                int talentPoints = std::stoi(args[1]);
+                std::string treeRep;
+                if (args.size() == 4) {
+                    TreeGeneratorSettings generatorSettings;
+                    generatorSettings.seed = static_cast<uint32_t>(std::stoul(args[2]));
+                    generatorSettings.nodeCount = std::stoi(args[3]);
+                    treeRep = generateTreeString(generatorSettings);
+                }
+                else {
+                    treeRep = getDefaultTreeString();
+                }
+                DifferentialReport report = runDifferentialCheck(treeRep, talentPoints);
+                printDifferentialReport(report);
+                return report.passed ? 0 : 2;
+            }
+        }
+        catch (std::exception& e) {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "Usage:" << std::endl;
+        std::cout << "  WowTalentTrees check <points>                     compare all counting engines on the default tree" << std::endl;
+        std::cout << "  WowTalentTrees check <points> <seed> <nodeCount>  compare all counting engines on a synthetic tree" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "WowTalentTrees.h"
+#include "BloodmalletCounter.h"
+
+namespace WowTalentTrees {
+    /*
+    Result of a single counting engine in the uint64 index space of the sorted DAG of the tree. Builds are sorted (mask, weight) pairs where weight is
+    the number of builds incl. switch talent choices (0 for engines that can't tell). In hash mode builds is empty and only counts and setHash are compared.
+    */
+    struct EngineResult {
+        std::string engine;
+        bool skipped = false;
+        std::string note;
+        double milliseconds = 0.0;
+        size_t buildCount = 0;
+        int64_t weightedCount = -1;
+        uint64_t setHash = 0;
+        std::vector<std::pair<uint64_t, int64_t>> builds;
+    };
+
+    struct DifferentialSettings {
+        //the legacy counter enumerates all orders of talent selections and gets slow very fast
+        int maxLegacyPoints = 8;
+        int maxBloodmalletPoints = 16;
+        //above this number of builds only counts and order independent hashes are compared
+        size_t hashThreshold = 5000000;
+        //number of differing builds that are listed per engine
+        int maxListedMismatches = 10;
+    };
+
+    struct DifferentialReport {
+        std::string treeRep;
+        int talentPoints = 0;
+        bool hashMode = false;
+        std::vector<EngineResult> engines;
+        std::vector<std::string> mismatches;
+        bool passed = true;
+    };
+
+    DifferentialReport runDifferentialCheck(std::string treeRep, int talentPoints, const DifferentialSettings& settings = DifferentialSettings());
+    uint64_t getBuildSetHash(const std::vector<std::pair<uint64_t, int64_t>>& builds);
+    std::vector<std::shared_ptr<bloodmallet::Talent>> createBloodmalletTalents(TalentTree tree, std::vector<std::string>& expandedIndices);
+    void printDifferentialReport(const DifferentialReport& report);
+    int runDifferentialCommand(int argc, char** argv);
+}
@@ -0,0 +1,114 @@
+#include "EnumerationTelemetry.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <tuple>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace WowTalentTrees {
+#ifdef WTT_TELEMETRY
+    thread_local TelemetryCounters threadTelemetry;
+#endif
+
+    void resetThreadTelemetry() {
+#ifdef WTT_TELEMETRY
+        threadTelemetry = TelemetryCounters();
+#endif
+    }
+
+    TelemetryCounters getThreadTelemetry() {
+#ifdef WTT_TELEMETRY
+        return threadTelemetry;
+#else
+        return TelemetryCounters();
+#endif
+    }
+
+    int getTelemetryThreadIndex() {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+
+    /*
+    Helper function that appends the counters as JSON key/value pairs.
+    */
+    void appendCountersJson(std::stringstream& json, const TelemetryCounters& counters) {
+        json << "\"nodesVisited\": " << counters.nodesVisited
+            << ", \"prunes\": " << counters.prunes
+            << ", \"gateRejections\": " << counters.gateRejections
+            << ", \"emittedBuilds\": " << counters.emittedBuilds;
+    }
+
+    /*
+    Transforms the telemetry of a run to JSON. Besides the raw per start point records it contains the totals and the load per thread
+    to make load imbalance in the threaded variant visible.
+    */
+    std::string telemetryToJson(const EnumerationTelemetry& telemetry) {
+        TelemetryCounters total;
+        double totalMilliseconds = 0.0;
+        //thread index -> (summed time, summed counters, start point count)
+        std::map<int, std::tuple<double, TelemetryCounters, int>> threadLoads;
+        for (auto& sp : telemetry.startPoints) {
+            total.nodesVisited += sp.counters.nodesVisited;
+            total.prunes += sp.counters.prunes;
+            total.gateRejections += sp.counters.gateRejections;
+            total.emittedBuilds += sp.counters.emittedBuilds;
+            totalMilliseconds += sp.milliseconds;
+            auto& [ms, counters, count] = threadLoads[sp.threadIndex];
+            ms += sp.milliseconds;
+            counters.nodesVisited += sp.counters.nodesVisited;
+            counters.prunes += sp.counters.prunes;
+            counters.gateRejections += sp.counters.gateRejections;
+            counters.emittedBuilds += sp.counters.emittedBuilds;
+            count++;
+        }
+
+        std::stringstream json;
+        json << "{\n";
+        json << "  \"kernel\": \"" << telemetry.kernel << "\",\n";
+        json << "  \"talentPoints\": " << telemetry.talentPoints << ",\n";
+        json << "  \"total\": { \"milliseconds\": " << totalMilliseconds << ", ";
+        appendCountersJson(json, total);
+        json << ", \"pruneRate\": " << (total.nodesVisited > 0 ? static_cast<double>(total.prunes) / total.nodesVisited : 0.0) << " },\n";
+        json << "  \"threads\": [\n";
+        size_t t = 0;
+        for (auto& [threadIndex, load] : threadLoads) {
+            json << "    { \"thread\": " << threadIndex << ", \"startPoints\": " << std::get<2>(load) << ", \"milliseconds\": " << std::get<0>(load) << ", ";
+            appendCountersJson(json, std::get<1>(load));
+            json << " }" << (++t < threadLoads.size() ? "," : "") << "\n";
+        }
+        json << "  ],\n";
+        json << "  \"startPoints\": [\n";
+        for (size_t i = 0; i < telemetry.startPoints.size(); i++) {
+            const StartPointTelemetry& sp = telemetry.startPoints[i];
+            json << "    { \"index\": " << sp.startPointIndex << ", \"talentIndex\": " << sp.talentIndex << ", \"thread\": " << sp.threadIndex
+                << ", \"milliseconds\": " << sp.milliseconds << ", ";
+            appendCountersJson(json, sp.counters);
+            json << " }" << (i + 1 < telemetry.startPoints.size() ? "," : "") << "\n";
+        }
+        json << "  ]\n";
+        json << "}\n";
+        return json.str();
+    }
+
+    /*
+    Writes the telemetry of a run to telemetry_<kernel>_<talentPoints>.json in the working directory (only if telemetry is compiled in).
+    */
+    void writeTelemetryJson(const EnumerationTelemetry& telemetry) {
+#ifdef WTT_TELEMETRY
+        std::string path = "telemetry_" + telemetry.kernel + "_" + std::to_string(telemetry.talentPoints) + ".json";
+        std::ofstream f(path);
+        f << telemetryToJson(telemetry);
+        std::cout << "Telemetry written to " << path << std::endl;
+#else
+        (void)telemetry;
+#endif
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+
+/*
+Low overhead counters for the DFS kernels (visitTalent, visitTalentParallel). Compiled out by default, define WTT_TELEMETRY in the
+preprocessor definitions to enable them. Counters are thread local so the threaded variant does not share any counter between threads.
+*/
+#ifdef WTT_TELEMETRY
+#define WTT_TELEMETRY_COUNT(counter) (++WowTalentTrees::threadTelemetry.counter)
+#else
+#define WTT_TELEMETRY_COUNT(counter) ((void)0)
+#endif
+
+namespace WowTalentTrees {
+    struct TelemetryCounters {
+        uint64_t nodesVisited = 0;
+        uint64_t prunes = 0;
+        uint64_t gateRejections = 0;
+        uint64_t emittedBuilds = 0;
+    };
+
+    struct StartPointTelemetry {
+        int startPointIndex = 0;
+        int talentIndex = 0;
+        int threadIndex = 0;
+        double milliseconds = 0.0;
+        TelemetryCounters counters;
+    };
+
+    struct EnumerationTelemetry {
+        std::string kernel;
+        int talentPoints = 0;
+        std::vector<StartPointTelemetry> startPoints;
+    };
+
+#ifdef WTT_TELEMETRY
+    extern thread_local TelemetryCounters threadTelemetry;
+#endif
+
+    void resetThreadTelemetry();
+    TelemetryCounters getThreadTelemetry();
+    int getTelemetryThreadIndex();
+
+    /*
+    Records the counters and the time of a single start point (root talent or StartPoint) for its lifetime. Does nothing if telemetry is compiled out.
+    The EnumerationTelemetry constructor appends a record and must only be used sequentially, threads write into preallocated records instead.
+    */
+    struct StartPointTelemetryScope {
+#ifdef WTT_TELEMETRY
+        StartPointTelemetry* record;
+        std::chrono::high_resolution_clock::time_point start;
+
+        StartPointTelemetryScope(StartPointTelemetry& record, int startPointIndex, int talentIndex) : record(&record) {
+            record.startPointIndex = startPointIndex;
+            record.talentIndex = talentIndex;
+            resetThreadTelemetry();
+            start = std::chrono::high_resolution_clock::now();
+        }
+
+        StartPointTelemetryScope(EnumerationTelemetry& telemetry, int startPointIndex, int talentIndex)
+            : StartPointTelemetryScope(telemetry.startPoints.emplace_back(), startPointIndex, talentIndex) {}
+
+        ~StartPointTelemetryScope() {
+            std::chrono::duration<double, std::milli> ms_double = std::chrono::high_resolution_clock::now() - start;
+            record->milliseconds = ms_double.count();
+            record->threadIndex = getTelemetryThreadIndex();
+            record->counters = getThreadTelemetry();
+        }
+#else
+        StartPointTelemetryScope(StartPointTelemetry&, int, int) {}
+        StartPointTelemetryScope(EnumerationTelemetry&, int, int) {}
+#endif
+    };
+
+    std::string telemetryToJson(const EnumerationTelemetry& telemetry);
+    void writeTelemetryJson(const EnumerationTelemetry& telemetry);
+}
@@ -0,0 +1,249 @@
+#include "HammingIndex.h"
+
+#include <array>
+#include <algorithm>
+#include <bit>
+
+namespace WowTalentTrees {
+    constexpr int maxChunkBits = 16;
+
+    /*
+    Helper function that creates all 16 bit flip patterns grouped by their popcount (ascending within each group).
+    */
+    std::array<std::vector<uint32_t>, maxChunkBits + 1> createChunkFlipTable() {
+        std::array<std::vector<uint32_t>, maxChunkBits + 1> table;
+        for (uint32_t flip = 0; flip < (1u << maxChunkBits); flip++) {
+            table[std::popcount(flip)].push_back(flip);
+        }
+        return table;
+    }
+    const std::array<std::vector<uint32_t>, maxChunkBits + 1> chunkFlips = createChunkFlipTable();
+
+    /*
+    Creates the multi index hashing tables for the given builds. Match ids are the positions in masks.
+    */
+    HammingIndex createHammingIndex(std::vector<uint64_t> masks) {
+        HammingIndex index;
+        index.masks = std::move(masks);
+        uint64_t andAll = ~0ULL;
+        uint64_t orAll = 0;
+        for (uint64_t mask : index.masks) {
+            andAll &= mask;
+            orAll |= mask;
+        }
+        index.constantBits = ~(andAll ^ orAll);
+        index.constantValue = andAll & index.constantBits;
+
+        std::vector<int> varyingBits;
+        for (int i = 0; i < 64; i++) {
+            if (!((index.constantBits >> i) & 1))
+                varyingBits.push_back(i);
+        }
+        index.chunkCount = std::max(1, static_cast<int>(varyingBits.size() + maxChunkBits - 1) / maxChunkBits);
+        index.chunkBitPositions.resize(index.chunkCount);
+        index.chunkMasks.resize(index.chunkCount, 0);
+        for (int i = 0; i < varyingBits.size(); i++) {
+            index.chunkBitPositions[i % index.chunkCount].push_back(varyingBits[i]);
+            index.chunkMasks[i % index.chunkCount] |= 1ULL << varyingBits[i];
+        }
+
+        //counting sort of the build ids into the buckets of every chunk
+        index.bucketOffsets.resize(index.chunkCount);
+        index.bucketIds.resize(index.chunkCount);
+        std::vector<uint32_t> keys(index.masks.size());
+        for (int c = 0; c < index.chunkCount; c++) {
+            std::vector<uint32_t>& offsets = index.bucketOffsets[c];
+            offsets.resize((size_t(1) << index.chunkBitPositions[c].size()) + 1, 0);
+            for (size_t i = 0; i < index.masks.size(); i++) {
+                keys[i] = getHammingChunkKey(index, c, index.masks[i]);
+                offsets[keys[i] + 1]++;
+            }
+            for (size_t b = 1; b < offsets.size(); b++) {
+                offsets[b] += offsets[b - 1];
+            }
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            index.bucketIds[c].resize(index.masks.size());
+            for (size_t i = 0; i < index.masks.size(); i++) {
+                index.bucketIds[c][fill[keys[i]]++] = static_cast<uint32_t>(i);
+            }
+        }
+        return index;
+    }
+
+    HammingIndex createHammingIndex(const std::vector<std::pair<std::bitset<128>, int>>& combinations) {
+        std::vector<uint64_t> masks;
+        masks.reserve(combinations.size());
+        for (auto& comb : combinations) {
+            masks.push_back(comb.first.to_ullong());
+        }
+        return createHammingIndex(std::move(masks));
+    }
+
+    /*
+    Gathers the bits of a chunk into a dense key.
+    */
+    uint32_t getHammingChunkKey(const HammingIndex& index, int chunk, uint64_t mask) {
+        uint32_t key = 0;
+        const std::vector<int>& positions = index.chunkBitPositions[chunk];
+        for (int b = 0; b < positions.size(); b++) {
+            key |= static_cast<uint32_t>((mask >> positions[b]) & 1) << b;
+        }
+        return key;
+    }
+
+    /*
+    Helper function that returns the number of bucket probes for all chunks at exactly the given chunk distance.
+    */
+    size_t getProbeCount(const HammingIndex& index, int chunkDistance) {
+        size_t probes = 0;
+        for (int c = 0; c < index.chunkCount; c++) {
+            uint32_t limit = 1u << index.chunkBitPositions[c].size();
+            const std::vector<uint32_t>& flips = chunkFlips[chunkDistance];
+            probes += std::lower_bound(flips.begin(), flips.end(), limit) - flips.begin();
+        }
+        return probes;
+    }
+
+    /*
+    Helper function that checks if a build (given as difference to the query) is reported by the given chunk at the given chunk distance,
+    which is the case for the smallest (chunk distance, chunk) pair over all chunks.
+    */
+    bool isFirstChunkMatch(const HammingIndex& index, uint64_t difference, int chunkDistance, int chunk) {
+        for (int c = 0; c < index.chunkCount; c++) {
+            int distance = std::popcount(difference & index.chunkMasks[c]);
+            if (distance < chunkDistance || (distance == chunkDistance && c < chunk))
+                return false;
+        }
+        return true;
+    }
+
+    /*
+    Helper function that adds all builds of the buckets at exactly the given chunk distance with a distance <= maxDistance to the matches.
+    */
+    void probeChunkDistance(const HammingIndex& index, uint64_t query, int chunkDistance, int maxDistance, std::vector<HammingMatch>& matches) {
+        for (int c = 0; c < index.chunkCount; c++) {
+            uint32_t key = getHammingChunkKey(index, c, query);
+            uint32_t limit = 1u << index.chunkBitPositions[c].size();
+            const std::vector<uint32_t>& offsets = index.bucketOffsets[c];
+            for (uint32_t flip : chunkFlips[chunkDistance]) {
+                if (flip >= limit)
+                    break;
+                uint32_t bucket = key ^ flip;
+                for (uint32_t b = offsets[bucket]; b < offsets[bucket + 1]; b++) {
+                    uint32_t id = index.bucketIds[c][b];
+                    uint64_t difference = index.masks[id] ^ query;
+                    int distance = std::popcount(difference);
+                    if (distance <= maxDistance && isFirstChunkMatch(index, difference, chunkDistance, c))
+                        matches.push_back({ id, distance });
+                }
+            }
+        }
+    }
+
+    /*
+    Helper function that sorts matches by distance first and id second.
+    */
+    void sortMatches(std::vector<HammingMatch>& matches) {
+        std::sort(matches.begin(), matches.end(), [](const HammingMatch& a, const HammingMatch& b) {
+            return a.distance < b.distance || (a.distance == b.distance && a.id < b.id);
+            });
+    }
+
+    /*
+    Returns all builds with a hamming distance <= radius to the query, sorted by distance. Falls back to brute force if probing the buckets
+    would touch more buckets than there are builds.
+    */
+    std::vector<HammingMatch> hammingRadiusSearch(const HammingIndex& index, uint64_t query, int radius) {
+        int constantDistance = std::popcount((query ^ index.constantValue) & index.constantBits);
+        int varyingRadius = radius - constantDistance;
+        if (index.masks.size() == 0 || varyingRadius < 0)
+            return {};
+        int maxChunkDistance = std::min(varyingRadius / index.chunkCount, maxChunkBits);
+        size_t probes = 0;
+        for (int s = 0; s <= maxChunkDistance; s++) {
+            probes += getProbeCount(index, s);
+        }
+        if (probes > index.masks.size())
+            return hammingRadiusSearchBruteForce(index.masks, query, radius);
+
+        std::vector<HammingMatch> matches;
+        for (int s = 0; s <= maxChunkDistance; s++) {
+            probeChunkDistance(index, query, s, radius, matches);
+        }
+        sortMatches(matches);
+        return matches;
+    }
+
+    /*
+    Returns the k nearest builds to the query (ties broken by id). Probes increasing chunk distances s, after probing s all builds with a
+    distance <= constant distance + chunkCount * (s + 1) - 1 are guaranteed to be found.
+    */
+    std::vector<HammingMatch> hammingKNearest(const HammingIndex& index, uint64_t query, int k) {
+        if (k <= 0 || index.masks.size() == 0)
+            return {};
+        int constantDistance = std::popcount((query ^ index.constantValue) & index.constantBits);
+        std::vector<HammingMatch> candidates;
+        size_t probes = 0;
+        for (int s = 0; s <= maxChunkBits; s++) {
+            probes += getProbeCount(index, s);
+            if (probes > index.masks.size())
+                return hammingKNearestBruteForce(index.masks, query, k);
+            probeChunkDistance(index, query, s, 64, candidates);
+            int guaranteedDistance = constantDistance + index.chunkCount * (s + 1) - 1;
+            size_t guaranteedCount = std::count_if(candidates.begin(), candidates.end(), [guaranteedDistance](const HammingMatch& m) {
+                return m.distance <= guaranteedDistance;
+                });
+            if (guaranteedCount >= k || candidates.size() == index.masks.size())
+                break;
+        }
+        sortMatches(candidates);
+        if (candidates.size() > k)
+            candidates.resize(k);
+        return candidates;
+    }
+
+    /*
+    Brute force baseline: XOR + popcount over all builds (distance pass is branch free and vectorizes).
+    */
+    std::vector<HammingMatch> hammingRadiusSearchBruteForce(const std::vector<uint64_t>& masks, uint64_t query, int radius) {
+        std::vector<uint8_t> distances(masks.size());
+        for (size_t i = 0; i < masks.size(); i++) {
+            distances[i] = static_cast<uint8_t>(std::popcount(masks[i] ^ query));
+        }
+        std::vector<HammingMatch> matches;
+        for (size_t i = 0; i < masks.size(); i++) {
+            if (distances[i] <= radius)
+                matches.push_back({ static_cast<uint32_t>(i), distances[i] });
+        }
+        sortMatches(matches);
+        return matches;
+    }
+
+    std::vector<HammingMatch> hammingKNearestBruteForce(const std::vector<uint64_t>& masks, uint64_t query, int k) {
+        if (k <= 0 || masks.size() == 0)
+            return {};
+        std::vector<uint8_t> distances(masks.size());
+        std::array<size_t, 65> histogram{};
+        for (size_t i = 0; i < masks.size(); i++) {
+            distances[i] = static_cast<uint8_t>(std::popcount(masks[i] ^ query));
+        }
+        for (uint8_t distance : distances) {
+            histogram[distance]++;
+        }
+        //smallest radius that contains at least k builds
+        int radius = 0;
+        size_t count = histogram[0];
+        while (count < k && radius < 64) {
+            count += histogram[++radius];
+        }
+        std::vector<HammingMatch> matches;
+        for (size_t i = 0; i < masks.size(); i++) {
+            if (distances[i] <= radius)
+                matches.push_back({ static_cast<uint32_t>(i), distances[i] });
+        }
+        sortMatches(matches);
+        if (matches.size() > k)
+            matches.resize(k);
+        return matches;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <bitset>
+
+namespace WowTalentTrees {
+    struct HammingMatch {
+        uint32_t id;
+        int distance;
+    };
+
+    /*
+    Multi index hashing over uint64 indices of enumerated builds (Norouzi et al., "Fast Search in Hamming Space with Multi-Index Hashing").
+    Bits that are the same for all builds are handled separately, the remaining bits are interleaved into up to 4 chunks of at most 16 bits
+    (neighbouring talents end up in different chunks which keeps the buckets balanced). Every chunk has a bucket table in CSR format.
+    If two builds have a distance <= r then at least one chunk has a distance <= r / chunkCount. A build is only reported through the
+    chunk with the smallest (chunk distance, chunk) pair, so results need no deduplication.
+    */
+    struct HammingIndex {
+        std::vector<uint64_t> masks;
+        uint64_t constantBits = 0;
+        uint64_t constantValue = 0;
+        int chunkCount = 0;
+        std::vector<std::vector<int>> chunkBitPositions;
+        std::vector<uint64_t> chunkMasks;
+        std::vector<std::vector<uint32_t>> bucketOffsets;
+        std::vector<std::vector<uint32_t>> bucketIds;
+    };
+
+    HammingIndex createHammingIndex(std::vector<uint64_t> masks);
+    HammingIndex createHammingIndex(const std::vector<std::pair<std::bitset<128>, int>>& combinations);
+    uint32_t getHammingChunkKey(const HammingIndex& index, int chunk, uint64_t mask);
+    std::vector<HammingMatch> hammingRadiusSearch(const HammingIndex& index, uint64_t query, int radius);
+    std::vector<HammingMatch> hammingKNearest(const HammingIndex& index, uint64_t query, int k);
+    std::vector<HammingMatch> hammingRadiusSearchBruteForce(const std::vector<uint64_t>& masks, uint64_t query, int radius);
+    std::vector<HammingMatch> hammingKNearestBruteForce(const std::vector<uint64_t>& masks, uint64_t query, int k);
+}
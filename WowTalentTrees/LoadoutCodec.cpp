@@ -0,0 +1,241 @@
+#include "LoadoutCodec.h"
+
+#include <stdexcept>
+#include <array>
+#include <bit>
+#include <algorithm>
+
+namespace WowTalentTrees {
+    constexpr char base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    constexpr int loadoutHeaderBytes = 5;
+
+    /*
+    Helper function that creates the reverse lookup table of the base64 alphabet (-1 for invalid characters).
+    */
+    constexpr std::array<int8_t, 256> createBase64LookupTable() {
+        std::array<int8_t, 256> table{};
+        for (auto& value : table) {
+            value = -1;
+        }
+        for (int i = 0; i < 64; i++) {
+            table[static_cast<uint8_t>(base64Alphabet[i])] = static_cast<int8_t>(i);
+        }
+        return table;
+    }
+    constexpr std::array<int8_t, 256> base64Lookup = createBase64LookupTable();
+
+    /*
+    Hash of the talents (keys and max points) a loadout refers to (32 bit FNV-1a). Loadouts of a tree with different talents are rejected.
+    Trees with switch talents of more than two choices (see createLoadoutCodec) hash their choice counts on top.
+    */
+    uint32_t getTreeHash(const BuildDecoder& decoder) {
+        uint32_t hash = 2166136261u;
+        auto hashByte = [&hash](uint8_t byte) {
+            hash ^= byte;
+            hash *= 16777619u;
+        };
+        for (int i = 0; i < decoder.talentKeys.size(); i++) {
+            for (char c : decoder.talentKeys[i]) {
+                hashByte(static_cast<uint8_t>(c));
+            }
+            hashByte(static_cast<uint8_t>(decoder.maxPoints[i]));
+            hashByte(';');
+        }
+        return hash;
+    }
+
+    /*
+    Creates the codec for a sorted DAG, uint64 indices of the codec are the same as the ones of the DAG.
+    */
+    LoadoutCodec createLoadoutCodec(const TreeDAGInfo& sortedTreeDAG) {
+        LoadoutCodec codec;
+        codec.decoder = createBuildDecoder(sortedTreeDAG);
+        const BuildDecoder& decoder = codec.decoder;
+        codec.treeHash = getTreeHash(decoder);
+
+        size_t talentCount = decoder.talentKeys.size();
+        codec.rankBits.resize(talentCount, 0);
+        codec.rankMasks.resize(talentCount);
+        for (int t = 0; t < talentCount; t++) {
+            while ((1 << codec.rankBits[t]) <= decoder.maxPoints[t]) {
+                codec.rankBits[t]++;
+            }
+            codec.payloadBits += codec.rankBits[t];
+            codec.rankMasks[t].resize(decoder.maxPoints[t] + 1, 0);
+        }
+        std::vector<int> switchChoices(talentCount, 0);
+        for (int i = 0; i < decoder.indexToTalent.size(); i++) {
+            int t = decoder.indexToTalent[i];
+            for (int rank = decoder.indexToRank[i]; rank <= decoder.maxPoints[t]; rank++) {
+                codec.rankMasks[t][rank] |= 1ULL << i;
+            }
+            if (sortedTreeDAG.sortedTalents[i]->talentSwitch >= 0) {
+                switchChoices[t] = sortedTreeDAG.sortedTalents[i]->choiceCount;
+            }
+        }
+        int choiceFieldBits = 0;
+        for (int t = 0; t < talentCount; t++) {
+            if (switchChoices[t] > 0) {
+                codec.switchTalents.push_back(t);
+                codec.choiceCounts.push_back(switchChoices[t]);
+                codec.choiceBits.push_back(std::bit_width(static_cast<unsigned int>(std::max(switchChoices[t], 2) - 1)));
+                choiceFieldBits += codec.choiceBits.back();
+            }
+        }
+        if (choiceFieldBits > 64)
+            throw std::logic_error("Choice fields of the switch talents exceed 64 bits, choices do not fit into uint64");
+        //2 choice trees keep the hash of the 1 bit format
+        for (int k = 0; k < codec.switchTalents.size(); k++) {
+            if (codec.choiceCounts[k] != 2) {
+                codec.treeHash = (codec.treeHash ^ static_cast<uint32_t>(codec.switchTalents[k] << 8 | codec.choiceCounts[k])) * 16777619u;
+            }
+        }
+        codec.payloadBits += choiceFieldBits;
+        codec.byteCount = loadoutHeaderBytes + (codec.payloadBits + 7) / 8;
+        codec.loadoutLength = (codec.byteCount * 8 + 5) / 6;
+        return codec;
+    }
+
+    /*
+    Creates the codec for a (not expanded) tree.
+    */
+    LoadoutCodec createLoadoutCodec(TalentTree tree) {
+        expandTreeTalents(tree);
+        TreeDAGInfo sortedTreeDAG = createSortedMinimalDAG(tree);
+        return createLoadoutCodec(sortedTreeDAG);
+    }
+
+    /*
+    Encodes a uint64 index (and optionally the choice of every switch talent, packed as consecutive fields of codec.choiceBits[k] bits for
+    codec.switchTalents[k], i.e. bit k for left/right switches) as loadout string.
+    */
+    std::string encodeLoadout(const LoadoutCodec& codec, uint64_t comb, uint64_t choices) {
+        //small fixed buffer, ranks of at most 64 single point talents need at most 64 bits plus at most 64 choice bits
+        std::array<uint8_t, loadoutHeaderBytes + 64> bytes{};
+        bytes[0] = loadoutCodecVersion;
+        for (int i = 0; i < 4; i++) {
+            bytes[1 + i] = static_cast<uint8_t>(codec.treeHash >> (8 * i));
+        }
+        int bitPos = loadoutHeaderBytes * 8;
+        auto writeBits = [&bytes, &bitPos](uint32_t value, int width) {
+            for (int b = 0; b < width; b++, bitPos++) {
+                bytes[bitPos >> 3] |= static_cast<uint8_t>(((value >> b) & 1) << (bitPos & 7));
+            }
+        };
+        for (int t = 0; t < codec.rankBits.size(); t++) {
+            writeBits(std::popcount(comb & codec.decoder.talentMasks[t]), codec.rankBits[t]);
+        }
+        for (int k = 0; k < codec.switchTalents.size(); k++) {
+            writeBits(static_cast<uint32_t>(choices & ((1ULL << codec.choiceBits[k]) - 1)), codec.choiceBits[k]);
+            choices >>= codec.choiceBits[k];
+        }
+
+        std::string loadout(codec.loadoutLength, 'A');
+        int c = 0;
+        for (int i = 0; i < codec.byteCount; i += 3) {
+            uint32_t group = bytes[i] << 16 | bytes[i + 1] << 8 | bytes[i + 2];
+            for (int j = 0; j < 4 && c < codec.loadoutLength; j++) {
+                loadout[c++] = base64Alphabet[(group >> (18 - 6 * j)) & 63];
+            }
+        }
+        return loadout;
+    }
+
+    /*
+    Decodes a loadout string to the uint64 index of the codec (and optionally the switch talent choices). Throws for loadouts of other
+    versions or trees and for malformed loadouts.
+    */
+    uint64_t decodeLoadout(const LoadoutCodec& codec, const std::string& loadout, uint64_t* choices) {
+        if (loadout.size() != codec.loadoutLength)
+            throw std::invalid_argument("Loadout has wrong length for this tree");
+        std::array<uint8_t, loadoutHeaderBytes + 64 + 3> bytes{};
+        int byteIndex = 0;
+        for (int i = 0; i < loadout.size(); i += 4) {
+            uint32_t group = 0;
+            for (int j = 0; j < 4; j++) {
+                int8_t value = i + j < loadout.size() ? base64Lookup[static_cast<uint8_t>(loadout[i + j])] : 0;
+                if (value < 0)
+                    throw std::invalid_argument("Loadout contains invalid characters");
+                group = group << 6 | value;
+            }
+            bytes[byteIndex++] = static_cast<uint8_t>(group >> 16);
+            bytes[byteIndex++] = static_cast<uint8_t>(group >> 8);
+            bytes[byteIndex++] = static_cast<uint8_t>(group);
+        }
+        if (bytes[0] != loadoutCodecVersion)
+            throw std::invalid_argument("Loadout version " + std::to_string(bytes[0]) + " is not supported");
+        uint32_t treeHash = bytes[1] | bytes[2] << 8 | bytes[3] << 16 | static_cast<uint32_t>(bytes[4]) << 24;
+        if (treeHash != codec.treeHash)
+            throw std::invalid_argument("Loadout belongs to a different tree");
+
+        int bitPos = loadoutHeaderBytes * 8;
+        auto readBits = [&bytes, &bitPos](int width) {
+            uint32_t value = 0;
+            for (int b = 0; b < width; b++, bitPos++) {
+                value |= ((bytes[bitPos >> 3] >> (bitPos & 7)) & 1) << b;
+            }
+            return value;
+        };
+        uint64_t comb = 0;
+        for (int t = 0; t < codec.rankBits.size(); t++) {
+            uint32_t rank = readBits(codec.rankBits[t]);
+            if (rank >= codec.rankMasks[t].size())
+                throw std::invalid_argument("Loadout has more points in " + codec.decoder.talentKeys[t] + " than possible");
+            comb |= codec.rankMasks[t][rank];
+        }
+        uint64_t switchChoices = 0;
+        int choiceShift = 0;
+        for (int k = 0; k < codec.switchTalents.size(); k++) {
+            uint32_t choice = readBits(codec.choiceBits[k]);
+            if (choice >= codec.choiceCounts[k])
+                throw std::invalid_argument("Loadout has choice " + std::to_string(choice) + " for " + codec.decoder.talentKeys[codec.switchTalents[k]] + " which does not exist");
+            switchChoices |= static_cast<uint64_t>(choice) << choiceShift;
+            choiceShift += codec.choiceBits[k];
+        }
+        if (choices != nullptr) {
+            *choices = switchChoices;
+        }
+        return comb;
+    }
+
+    /*
+    Bulk versions of encodeLoadout/decodeLoadout, every loadout is independent and has the same length so whole result sets run in parallel.
+    */
+    std::vector<std::string> encodeLoadouts(const LoadoutCodec& codec, const std::vector<uint64_t>& combinations) {
+        std::vector<std::string> loadouts(combinations.size());
+#pragma omp parallel for
+        for (long long i = 0; i < static_cast<long long>(combinations.size()); i++) {
+            loadouts[i] = encodeLoadout(codec, combinations[i]);
+        }
+        return loadouts;
+    }
+
+    std::vector<std::string> encodeLoadouts(const LoadoutCodec& codec, const std::vector<std::pair<std::bitset<128>, int>>& combinations) {
+        std::vector<uint64_t> masks;
+        masks.reserve(combinations.size());
+        for (auto& comb : combinations) {
+            masks.push_back(comb.first.to_ullong());
+        }
+        return encodeLoadouts(codec, masks);
+    }
+
+    std::vector<uint64_t> decodeLoadouts(const LoadoutCodec& codec, const std::vector<std::string>& loadouts) {
+        std::vector<uint64_t> combinations(loadouts.size());
+        //exceptions must not leave the parallel region, invalid loadouts are decoded again afterwards to throw
+        std::vector<char> failed(loadouts.size(), 0);
+#pragma omp parallel for
+        for (long long i = 0; i < static_cast<long long>(loadouts.size()); i++) {
+            try {
+                combinations[i] = decodeLoadout(codec, loadouts[i]);
+            }
+            catch (std::exception&) {
+                failed[i] = 1;
+            }
+        }
+        for (size_t i = 0; i < loadouts.size(); i++) {
+            if (failed[i])
+                decodeLoadout(codec, loadouts[i]);
+        }
+        return combinations;
+    }
+}
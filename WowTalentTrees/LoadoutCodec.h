@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "WowTalentTrees.h"
+#include "BuildDecoder.h"
+
+namespace WowTalentTrees {
+    constexpr uint8_t loadoutCodecVersion = 1;
+
+    /*
+    Compact import/export codec for builds. A loadout string is the base64 encoding (standard alphabet, no padding) of
+    1 byte version, 4 bytes tree hash (little endian) and the bit packed payload: the rank of every talent in BuildDecoder::talentKeys order
+    with just enough bits for its max points, followed by the choice of every switch talent with ceil(log2(choices)) bits (one bit for left/right switches).
+    All loadouts of a tree have the same length, which makes bulk encoding/decoding trivially parallel.
+    */
+    struct LoadoutCodec {
+        BuildDecoder decoder;
+        uint32_t treeHash = 0;
+        std::vector<int> rankBits;
+        //per talent and rank r: mask of all single point talents with rank <= r, decoding is a lookup per talent
+        std::vector<std::vector<uint64_t>> rankMasks;
+        std::vector<int> switchTalents;
+        //per switch talent: number of choices and width of its choice field
+        std::vector<int> choiceCounts;
+        std::vector<int> choiceBits;
+        int payloadBits = 0;
+        int byteCount = 0;
+        int loadoutLength = 0;
+    };
+
+    LoadoutCodec createLoadoutCodec(const TreeDAGInfo& sortedTreeDAG);
+    LoadoutCodec createLoadoutCodec(TalentTree tree);
+    uint32_t getTreeHash(const BuildDecoder& decoder);
+    std::string encodeLoadout(const LoadoutCodec& codec, uint64_t comb, uint64_t choices = 0);
+    uint64_t decodeLoadout(const LoadoutCodec& codec, const std::string& loadout, uint64_t* choices = nullptr);
+    std::vector<std::string> encodeLoadouts(const LoadoutCodec& codec, const std::vector<uint64_t>& combinations);
+    std::vector<std::string> encodeLoadouts(const LoadoutCodec& codec, const std::vector<std::pair<std::bitset<128>, int>>& combinations);
+    std::vector<uint64_t> decodeLoadouts(const LoadoutCodec& codec, const std::vector<std::string>& loadouts);
+}
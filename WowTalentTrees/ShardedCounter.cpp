@@ -0,0 +1,262 @@
+#include "ShardedCounter.h"
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <chrono>
+#include <algorithm>
+
+namespace WowTalentTrees {
+    //number of start points each shard gets on average, more start points give a better balance between shards
+    constexpr int shardStartPointsPerShard = 64;
+    constexpr char shardFileMagic[4] = { 'W', 'T', 'T', 'S' };
+    constexpr uint32_t shardFileVersion = 1;
+
+    /*
+    Number of start points the frontier is split into. Only depends on the shard count, so every process of a run (and every retry of a shard)
+    computes the exact same frontier.
+    */
+    int getShardStartPointCount(int shardCount) {
+        return shardCount * shardStartPointsPerShard;
+    }
+
+    /*
+    Deterministic shard assignment: start point k of the (deterministic) getStartPoints frontier belongs to shard k % shardCount.
+    The breadth first frontier has large sub trees first and small sub trees last, round robin keeps the shards roughly balanced.
+    */
+    std::vector<StartPoint> getShardStartPoints(const std::vector<StartPoint>& startPoints, int shardIndex, int shardCount) {
+        std::vector<StartPoint> shardStartPoints;
+        for (int i = shardIndex; i < startPoints.size(); i += shardCount) {
+            shardStartPoints.push_back(startPoints[i]);
+        }
+        return shardStartPoints;
+    }
+
+    /*
+    Counts all configurations for 1 up to N talent points (like countConfigurationsFastParallel) of shard shardIndex out of shardCount.
+    Combinations that are completed while building the frontier (prefixes) are part of shard 0.
+    */
+    ShardResult countConfigurationsShard(TalentTree tree, int shardIndex, int shardCount) {
+        if (shardCount < 1 || shardIndex < 0 || shardIndex >= shardCount)
+            throw std::invalid_argument("Shard index has to be in [0, shardCount)");
+        int talentPoints = tree.unspentTalentPoints;
+        //expand notes in tree
+        expandTreeTalents(tree);
+
+        TreeDAGInfo sortedTreeDAG = createSortedMinimalDAG(tree);
+        if (sortedTreeDAG.sortedTalents.size() > 64)
+            throw std::logic_error("Number of talents exceeds 64, need different indexing type instead of uint64");
+
+        ShardResult result;
+        result.talentPoints = talentPoints;
+        result.shardIndex = shardIndex;
+        result.shardCount = shardCount;
+        result.combinations.resize(talentPoints);
+        std::vector<int> allCombinations(talentPoints, 0);
+
+        std::vector<std::vector<std::pair<std::bitset<128>, int>>> prefixCombinations(talentPoints);
+        std::vector<int> prefixAllCombinations(talentPoints, 0);
+        std::vector<StartPoint> startPoints = getStartPoints(sortedTreeDAG, talentPoints, getShardStartPointCount(shardCount), prefixCombinations, prefixAllCombinations);
+        if (shardIndex == 0) {
+            result.combinations = prefixCombinations;
+            allCombinations = prefixAllCombinations;
+        }
+
+        for (auto& sp : getShardStartPoints(startPoints, shardIndex, shardCount)) {
+            visitTalentParallel(sp.talentIndex, sp.visitedTalents, sp.currentPosTalIndex, sp.currentMultiplier, sp.talentPointsSpent, sp.talentPointsLeft, sp.possibleTalents, sortedTreeDAG, result.combinations, allCombinations);
+        }
+        result.allCombinations.assign(allCombinations.begin(), allCombinations.end());
+
+        return result;
+    }
+
+    /*
+    Writes a shard result in a simple binary format (native endianness):
+    magic "WTTS", uint32 version, int32 talentPoints, int32 shardIndex, int32 shardCount,
+    then for every talent point count: uint64 combination count, int64 count with switch talents, combination count x (uint64 mask, int32 multiplier).
+    */
+    void writeShardResult(const ShardResult& result, std::string path) {
+        std::ofstream f(path, std::ios::binary);
+        if (!f)
+            throw std::runtime_error("Could not open shard file " + path + " for writing");
+        f.write(shardFileMagic, sizeof(shardFileMagic));
+        f.write(reinterpret_cast<const char*>(&shardFileVersion), sizeof(shardFileVersion));
+        int32_t header[3] = { result.talentPoints, result.shardIndex, result.shardCount };
+        f.write(reinterpret_cast<const char*>(header), sizeof(header));
+        for (int i = 0; i < result.talentPoints; i++) {
+            uint64_t count = result.combinations[i].size();
+            int64_t allCount = result.allCombinations[i];
+            f.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            f.write(reinterpret_cast<const char*>(&allCount), sizeof(allCount));
+            for (auto& comb : result.combinations[i]) {
+                uint64_t mask = comb.first.to_ullong();
+                int32_t multiplier = comb.second;
+                f.write(reinterpret_cast<const char*>(&mask), sizeof(mask));
+                f.write(reinterpret_cast<const char*>(&multiplier), sizeof(multiplier));
+            }
+        }
+        if (!f)
+            throw std::runtime_error("Could not write shard file " + path);
+    }
+
+    /*
+    Reads a shard result that was written by writeShardResult.
+    */
+    ShardResult readShardResult(std::string path) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f)
+            throw std::runtime_error("Could not open shard file " + path);
+        char magic[4];
+        uint32_t version = 0;
+        f.read(magic, sizeof(magic));
+        f.read(reinterpret_cast<char*>(&version), sizeof(version));
+        if (!f || !std::equal(magic, magic + 4, shardFileMagic) || version != shardFileVersion)
+            throw std::runtime_error("File " + path + " is not a shard file of version " + std::to_string(shardFileVersion));
+        int32_t header[3];
+        f.read(reinterpret_cast<char*>(header), sizeof(header));
+        ShardResult result;
+        result.talentPoints = header[0];
+        result.shardIndex = header[1];
+        result.shardCount = header[2];
+        if (!f || result.talentPoints < 0)
+            throw std::runtime_error("Shard file " + path + " has a corrupt header");
+        result.combinations.resize(result.talentPoints);
+        result.allCombinations.resize(result.talentPoints, 0);
+        for (int i = 0; i < result.talentPoints; i++) {
+            uint64_t count = 0;
+            f.read(reinterpret_cast<char*>(&count), sizeof(count));
+            f.read(reinterpret_cast<char*>(&result.allCombinations[i]), sizeof(int64_t));
+            if (!f)
+                throw std::runtime_error("Shard file " + path + " is truncated");
+            result.combinations[i].reserve(count);
+            for (uint64_t j = 0; j < count; j++) {
+                uint64_t mask = 0;
+                int32_t multiplier = 0;
+                f.read(reinterpret_cast<char*>(&mask), sizeof(mask));
+                f.read(reinterpret_cast<char*>(&multiplier), sizeof(multiplier));
+                result.combinations[i].push_back(std::pair<std::bitset<128>, int>(std::bitset<128>(mask), multiplier));
+            }
+            if (!f)
+                throw std::runtime_error("Shard file " + path + " is truncated");
+        }
+        return result;
+    }
+
+    /*
+    Merges the results of all shards of a run into one result (which is equivalent to shard 0 of 1). Throws if shards are missing,
+    duplicated or belong to different runs.
+    */
+    ShardResult mergeShardResults(const std::vector<ShardResult>& shards) {
+        if (shards.size() == 0)
+            throw std::invalid_argument("No shards to merge");
+        int talentPoints = shards[0].talentPoints;
+        int shardCount = shards[0].shardCount;
+        if (shards.size() != shardCount)
+            throw std::invalid_argument("Expected " + std::to_string(shardCount) + " shards but got " + std::to_string(shards.size()));
+        std::vector<bool> shardSeen(shardCount, false);
+        for (auto& shard : shards) {
+            if (shard.talentPoints != talentPoints || shard.shardCount != shardCount)
+                throw std::invalid_argument("Shards belong to different runs");
+            if (shard.shardIndex < 0 || shard.shardIndex >= shardCount || shardSeen[shard.shardIndex])
+                throw std::invalid_argument("Shard " + std::to_string(shard.shardIndex) + " is invalid or duplicated");
+            shardSeen[shard.shardIndex] = true;
+        }
+
+        ShardResult merged;
+        merged.talentPoints = talentPoints;
+        merged.combinations.resize(talentPoints);
+        merged.allCombinations.resize(talentPoints, 0);
+        for (int i = 0; i < talentPoints; i++) {
+            size_t count = 0;
+            for (auto& shard : shards) {
+                count += shard.combinations[i].size();
+            }
+            merged.combinations[i].reserve(count);
+            for (auto& shard : shards) {
+                merged.combinations[i].insert(merged.combinations[i].end(), shard.combinations[i].begin(), shard.combinations[i].end());
+                merged.allCombinations[i] += shard.allCombinations[i];
+            }
+        }
+        return merged;
+    }
+
+    /*
+    Compares the counts of a (merged) result with the single process counter countConfigurationsFastParallel.
+    */
+    bool verifyShardResult(const ShardResult& result, TalentTree tree) {
+        tree.unspentTalentPoints = result.talentPoints;
+        std::vector<std::vector<std::pair<std::bitset<128>, int>>> combinations = countConfigurationsFastParallel(tree);
+        std::vector<int64_t> allCombinations(result.talentPoints, 0);
+        for (int i = 0; i < result.talentPoints; i++) {
+            for (auto& comb : combinations[i]) {
+                allCombinations[i] += comb.second;
+            }
+        }
+        bool valid = true;
+        for (int i = 0; i < result.talentPoints; i++) {
+            if (combinations[i].size() != result.combinations[i].size() || allCombinations[i] != result.allCombinations[i]) {
+                std::cout << "Mismatch for " << i + 1 << " talent points: " << result.combinations[i].size() << "/" << result.allCombinations[i]
+                    << " (sharded) vs " << combinations[i].size() << "/" << allCombinations[i] << " (single process)" << std::endl;
+                valid = false;
+            }
+        }
+        return valid;
+    }
+
+    void printShardUsage() {
+        std::cout << "Usage:" << std::endl;
+        std::cout << "  WowTalentTrees shard <talentPoints> <shardIndex> <shardCount> <outputFile>" << std::endl;
+        std::cout << "  WowTalentTrees merge <outputFile> <shardFile> [<shardFile> ...] [--verify]" << std::endl;
+    }
+
+    /*
+    Command line entry point of the multi process enumeration. Runs shard i of N on the default tree or merges (and optionally verifies) shard files.
+    */
+    int runShardCommand(int argc, char** argv) {
+        std::vector<std::string> args(argv + 1, argv + argc);
+        try {
+            if (args[0] == "shard" && args.size() == 5) {
+                TalentTree tree = getDefaultTree();
+                tree.unspentTalentPoints = std::stoi(args[1]);
+                int shardIndex = std::stoi(args[2]);
+                int shardCount = std::stoi(args[3]);
+
+                auto t1 = std::chrono::high_resolution_clock::now();
+                ShardResult result = countConfigurationsShard(tree, shardIndex, shardCount);
+                auto t2 = std::chrono::high_resolution_clock::now();
+                std::chrono::duration<double, std::milli> ms_double = t2 - t1;
+                std::cout << "Shard " << shardIndex << "/" << shardCount << " operation time: " << ms_double.count() << " ms" << std::endl;
+
+                writeShardResult(result, args[4]);
+                return 0;
+            }
+            if (args[0] == "merge" && args.size() >= 3) {
+                bool verify = args.back() == "--verify";
+                size_t shardFileEnd = verify ? args.size() - 1 : args.size();
+                std::vector<ShardResult> shards;
+                for (size_t i = 2; i < shardFileEnd; i++) {
+                    shards.push_back(readShardResult(args[i]));
+                }
+                ShardResult merged = mergeShardResults(shards);
+                for (int i = 0; i < merged.talentPoints; i++) {
+                    std::cout << "Number of configurations for " << i + 1 << " talent points without switch talents: " << merged.combinations[i].size() << " and with : " << merged.allCombinations[i] << std::endl;
+                }
+                writeShardResult(merged, args[1]);
+                if (verify) {
+                    if (!verifyShardResult(merged, getDefaultTree())) {
+                        std::cout << "Verification against single process count failed!" << std::endl;
+                        return 2;
+                    }
+                    std::cout << "Verification against single process count succeeded." << std::endl;
+                }
+                return 0;
+            }
+        }
+        catch (std::exception& e) {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+        printShardUsage();
+        return 1;
+    }
+}
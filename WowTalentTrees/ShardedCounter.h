@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <bitset>
+#include <cstdint>
+
+#include "WowTalentTrees.h"
+
+namespace WowTalentTrees {
+    /*
+    Result of a single shard (or of several merged shards) of the multi process configuration count. Holds the combinations for 1 up to talentPoints
+    talent points (same indexing as countConfigurationsFastParallel) and the counts including switch talents.
+    */
+    struct ShardResult {
+        int talentPoints = 0;
+        int shardIndex = 0;
+        int shardCount = 1;
+        std::vector<std::vector<std::pair<std::bitset<128>, int>>> combinations;
+        std::vector<int64_t> allCombinations;
+    };
+
+    int getShardStartPointCount(int shardCount);
+    std::vector<StartPoint> getShardStartPoints(const std::vector<StartPoint>& startPoints, int shardIndex, int shardCount);
+    ShardResult countConfigurationsShard(TalentTree tree, int shardIndex, int shardCount);
+    void writeShardResult(const ShardResult& result, std::string path);
+    ShardResult readShardResult(std::string path);
+    ShardResult mergeShardResults(const std::vector<ShardResult>& shards);
+    bool verifyShardResult(const ShardResult& result, TalentTree tree);
+    void printShardUsage();
+    int runShardCommand(int argc, char** argv);
+}
@@ -0,0 +1,76 @@
+#include "StaticTreeCounter.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <cstdlib>
+
+namespace WowTalentTrees {
+    //sorted DAG of the default tree, parsed by the compiler
+    constexpr auto defaultTreeDAG = parseStaticTree<getStaticTalentCount(defaultTreeRep)>(defaultTreeRep);
+
+    /*
+    Helper function that converts counter results to sorted uint64 indices for comparison.
+    */
+    std::vector<std::pair<uint64_t, int>> getSortedIndices(const std::vector<std::pair<std::bitset<128>, int>>& combinations) {
+        std::vector<std::pair<uint64_t, int>> indices;
+        indices.reserve(combinations.size());
+        for (auto& comb : combinations) {
+            indices.push_back({ comb.first.to_ullong(), comb.second });
+        }
+        std::sort(indices.begin(), indices.end());
+        return indices;
+    }
+
+    /*
+    Benchmarks the compile time specialized counter against the kernel of countConfigurationsFast (visitTalent on the int* mDAG arrays) on the default tree
+    and checks that both produce identical builds. Only the counting kernels are timed, parsing, expansion and DAG creation of the runtime path happen once
+    up front. Times are the best of the given number of repetitions.
+    */
+    void staticCombinationCount(int points, int repetitions) {
+        TalentTree tree = getDefaultTree();
+        expandTreeTalents(tree);
+        TreeDAGInfo sortedTreeDAG = createSortedMinimalDAG(tree);
+        if (sortedTreeDAG.sortedTalents.size() > 64)
+            throw std::logic_error("Number of talents exceeds 64, need different indexing type instead of uint64");
+        int* mDAG = convertMinimalTreeDAGToArray(sortedTreeDAG);
+        int* ptsReq = convertMinimalTreeDAGToPtsReqArray(sortedTreeDAG);
+
+        double fastTime = 0.0;
+        double staticTime = 0.0;
+        std::vector<std::pair<std::bitset<128>, int>> fastCombinations;
+        std::vector<std::pair<std::bitset<128>, int>> staticCombinations;
+        int fastAllCombinations = 0;
+        int staticAllCombinations = 0;
+        for (int r = 0; r < repetitions; r++) {
+            //same root loop as countConfigurationsFast
+            auto t1 = std::chrono::high_resolution_clock::now();
+            fastCombinations.clear();
+            fastAllCombinations = 0;
+            std::vector<int> possibleTalents(sortedTreeDAG.rootIndices.begin(), sortedTreeDAG.rootIndices.end());
+            for (int i = 0; i < possibleTalents.size(); i++) {
+                if (sortedTreeDAG.sortedTalents[possibleTalents[i]]->pointsRequired == 0) {
+                    visitTalent(possibleTalents[i], 0, i + 1, 1, 0, points, possibleTalents, mDAG, ptsReq, fastCombinations, fastAllCombinations);
+                }
+            }
+            auto t2 = std::chrono::high_resolution_clock::now();
+            staticCombinations = StaticTreeCounter<defaultTreeDAG>::countConfigurations(points, staticAllCombinations);
+            auto t3 = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double, std::milli> fastDuration = t2 - t1;
+            std::chrono::duration<double, std::milli> staticDuration = t3 - t2;
+            if (r == 0 || fastDuration.count() < fastTime)
+                fastTime = fastDuration.count();
+            if (r == 0 || staticDuration.count() < staticTime)
+                staticTime = staticDuration.count();
+        }
+        free(mDAG);
+        free(ptsReq);
+
+        std::vector<std::pair<uint64_t, int>> fastIndices = getSortedIndices(fastCombinations);
+        std::vector<std::pair<uint64_t, int>> staticIndices = getSortedIndices(staticCombinations);
+        std::cout << "Static counter: " << staticCombinations.size() << " configurations without switch talents and " << staticAllCombinations << " with" << std::endl;
+        std::cout << "Builds identical to countConfigurationsFast: " << (fastIndices == staticIndices && fastAllCombinations == staticAllCombinations ? "yes" : "NO") << std::endl;
+        std::cout << "countConfigurationsFast kernel time: " << fastTime << " ms, static counter time: " << staticTime << " ms, speedup: " << fastTime / staticTime << std::endl;
+    }
+}
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <bitset>
+#include <string_view>
+#include <utility>
+#include <stdexcept>
+#include <cstdint>
+#include <bit>
+
+#include "WowTalentTrees.h"
+#include "EnumerationTelemetry.h"
+
+namespace WowTalentTrees {
+    //max parents/children per talent in a compile time parsed tree
+    constexpr int staticTreeMaxConnections = 8;
+
+    /*
+    Compile time version of the sorted minimal DAG (see createSortedMinimalDAG) of an expanded tree with N talents. Children are stored as bit masks
+    of their sorted indices, the talent order is the same as the one of the runtime DAG so uint64 indices of both paths are identical.
+    */
+    template<int N>
+    struct StaticTreeDAG {
+        int nodeCount = N;
+        int rootCount = 0;
+        std::array<int, N> multipliers{};
+        std::array<int, N> pointsRequired{};
+        std::array<uint64_t, N> childMasks{};
+    };
+
+    /*
+    Talent of the tree representation string while parsing at compile time.
+    */
+    struct StaticTreeTalent {
+        std::string_view index;
+        int type = 0;
+        int maxPoints = 0;
+        int pointsRequired = 0;
+        int choiceCount = 2;
+        int parentCount = 0;
+        std::array<int, staticTreeMaxConnections> parents{};
+        int childCount = 0;
+        std::array<int, staticTreeMaxConnections> children{};
+    };
+
+    /*
+    Helper function that parses the (non negative) integer at the start of a string.
+    */
+    constexpr int parseStaticInt(std::string_view s) {
+        int value = 0;
+        for (char c : s) {
+            if (c < '0' || c > '9')
+                break;
+            value = value * 10 + (c - '0');
+        }
+        return value;
+    }
+
+    /*
+    Helper function that returns the max points part of a talent entry "NAME.TalentType:maxPoints(_ISSWITCH(#CHOICES))(@POINTSREQUIRED)-PARENTS+CHILDREN".
+    */
+    constexpr std::string_view getStaticMaxPointsPart(std::string_view entry) {
+        size_t colon = entry.find(':');
+        return entry.substr(colon + 1, entry.find('-') - colon - 1);
+    }
+
+    /*
+    Number of talents of the expanded tree (sum of max points) for a tree representation string, this is the template argument of parseStaticTree.
+    */
+    constexpr int getStaticTalentCount(std::string_view treeRep) {
+        int count = 0;
+        while (treeRep.size() > 0) {
+            size_t end = treeRep.find(';');
+            std::string_view entry = treeRep.substr(0, end);
+            treeRep = end == std::string_view::npos ? std::string_view() : treeRep.substr(end + 1);
+            if (entry.size() == 0)
+                continue;
+            int maxPoints = parseStaticInt(getStaticMaxPointsPart(entry));
+            count += maxPoints > 1 ? maxPoints : 1;
+        }
+        return count;
+    }
+
+    /*
+    Parses a tree representation string (same format and same restrictions as parseTree) into the sorted DAG at compile time.
+    Mirrors parseTree, expandTreeTalents and createSortedMinimalDAG step by step. Errors in constant evaluation are compile errors.
+    */
+    template<int N>
+    constexpr StaticTreeDAG<N> parseStaticTree(std::string_view treeRep) {
+        static_assert(N <= 64, "Number of talents exceeds 64, need different indexing type instead of uint64");
+        std::array<StaticTreeTalent, N> talents{};
+        int talentCount = 0;
+        std::array<int, N> roots{};
+        int rootCount = 0;
+        auto findOrAddTalent = [&talents, &talentCount](std::string_view index) {
+            for (int i = 0; i < talentCount; i++) {
+                if (talents[i].index == index)
+                    return i;
+            }
+            if (talentCount == N)
+                throw std::logic_error("More talents referenced than defined");
+            talents[talentCount].index = index;
+            return talentCount++;
+        };
+        auto addConnection = [](std::array<int, staticTreeMaxConnections>& connections, int& count, int talent) {
+            if (count == staticTreeMaxConnections)
+                throw std::logic_error("Talent has too many connections for staticTreeMaxConnections");
+            connections[count++] = talent;
+        };
+
+        //parseTree
+        while (treeRep.size() > 0) {
+            size_t end = treeRep.find(';');
+            std::string_view entry = treeRep.substr(0, end);
+            treeRep = end == std::string_view::npos ? std::string_view() : treeRep.substr(end + 1);
+            if (entry.size() == 0)
+                continue;
+            int t = findOrAddTalent(entry.substr(0, entry.find('.')));
+            talents[t].type = entry[entry.find('.') + 1] - '0';
+            std::string_view maxPointsPart = getStaticMaxPointsPart(entry);
+            talents[t].maxPoints = parseStaticInt(maxPointsPart);
+            if (maxPointsPart.find('@') != std::string_view::npos) {
+                talents[t].pointsRequired = parseStaticInt(maxPointsPart.substr(maxPointsPart.find('@') + 1));
+            }
+            if (maxPointsPart.find('#') != std::string_view::npos) {
+                talents[t].choiceCount = parseStaticInt(maxPointsPart.substr(maxPointsPart.find('#') + 1));
+            }
+            size_t dash = entry.find('-');
+            size_t plus = entry.find('+');
+            std::string_view parents = entry.substr(dash + 1, plus - dash - 1);
+            std::string_view children = entry.substr(plus + 1);
+            while (parents.size() > 0) {
+                size_t comma = parents.find(',');
+                addConnection(talents[t].parents, talents[t].parentCount, findOrAddTalent(parents.substr(0, comma)));
+                parents = comma == std::string_view::npos ? std::string_view() : parents.substr(comma + 1);
+            }
+            while (children.size() > 0) {
+                size_t comma = children.find(',');
+                addConnection(talents[t].children, talents[t].childCount, findOrAddTalent(children.substr(0, comma)));
+                children = comma == std::string_view::npos ? std::string_view() : children.substr(comma + 1);
+            }
+            if (talents[t].parentCount == 0) {
+                roots[rootCount++] = t;
+            }
+        }
+
+        //expandTreeTalents: talent t becomes the chain firstPart[t], ..., firstPart[t] + max points - 1, children are attached to the last part
+        std::array<int, N> firstPart{};
+        int expandedCount = 0;
+        for (int t = 0; t < talentCount; t++) {
+            firstPart[t] = expandedCount;
+            expandedCount += talents[t].maxPoints > 1 ? talents[t].maxPoints : 1;
+        }
+        if (expandedCount != N)
+            throw std::logic_error("Number of expanded talents does not match the template argument");
+        std::array<int, N> parentCounts{};
+        std::array<int, N> multipliers{};
+        std::array<int, N> pointsRequired{};
+        std::array<int, N> childCounts{};
+        std::array<std::array<int, staticTreeMaxConnections>, N> children{};
+        for (int t = 0; t < talentCount; t++) {
+            int parts = talents[t].maxPoints > 1 ? talents[t].maxPoints : 1;
+            for (int p = 0; p < parts; p++) {
+                int e = firstPart[t] + p;
+                multipliers[e] = talents[t].type == static_cast<int>(TalentType::SWITCH) ? talents[t].choiceCount : 1;
+                parentCounts[e] = p == 0 ? talents[t].parentCount : 1;
+                if (p < parts - 1) {
+                    children[e][childCounts[e]++] = e + 1;
+                }
+                else {
+                    for (int c = 0; c < talents[t].childCount; c++) {
+                        children[e][childCounts[e]++] = firstPart[talents[t].children[c]];
+                    }
+                }
+            }
+            pointsRequired[firstPart[t]] = talents[t].pointsRequired;
+        }
+
+        //createSortedMinimalDAG: Kahn's algorithm, the queue is kept sorted by points required (descending, stable like the insertion sort std::sort uses for small ranges)
+        std::array<int, N> queue{};
+        int queueBegin = 0;
+        int queueEnd = 0;
+        auto pushAndSort = [&queue, &queueBegin, &queueEnd, &pointsRequired](int e) {
+            int i = queueEnd++;
+            queue[i] = e;
+            while (i > queueBegin && pointsRequired[queue[i - 1]] < pointsRequired[queue[i]]) {
+                std::swap(queue[i - 1], queue[i]);
+                i--;
+            }
+        };
+        for (int r = 0; r < rootCount; r++) {
+            pushAndSort(firstPart[roots[r]]);
+        }
+        std::array<int, N> sortedPosition{};
+        int sortedCount = 0;
+        while (queueBegin < queueEnd) {
+            int e = queue[queueBegin++];
+            sortedPosition[e] = sortedCount++;
+            for (int c = 0; c < childCounts[e]; c++) {
+                int child = children[e][c];
+                if (--parentCounts[child] == 0) {
+                    pushAndSort(child);
+                }
+            }
+        }
+        if (sortedCount != N)
+            throw std::logic_error("Tree is not a connected DAG");
+
+        StaticTreeDAG<N> dag;
+        dag.rootCount = rootCount;
+        for (int e = 0; e < N; e++) {
+            int i = sortedPosition[e];
+            dag.multipliers[i] = multipliers[e];
+            dag.pointsRequired[i] = pointsRequired[e];
+            for (int c = 0; c < childCounts[e]; c++) {
+                dag.childMasks[i] |= 1ULL << sortedPosition[children[e][c]];
+            }
+        }
+        return dag;
+    }
+
+    /*
+    Fast configuration count (same results as countConfigurationsFast) specialized for a compile time DAG. Every talent has its own instantiation of the
+    DFS kernel, so multiplier, children, gate and pruning bound are immediates. The sorted vector of possible talents is a bit mask: talents that can be
+    visited next are exactly the possible talents with a higher index than the current one (see visitTalent).
+    */
+    template<const auto& DAG>
+    struct StaticTreeCounter {
+        static constexpr int N = DAG.nodeCount;
+        using VisitFunction = void (*)(uint64_t, uint64_t, int, int, int, std::vector<std::pair<std::bitset<128>, int>>&, int&);
+
+        template<int TalentIndex>
+        static void visitTalent(
+            uint64_t visitedTalents,
+            uint64_t possibleTalents,
+            int currentMultiplier,
+            int talentPointsSpent,
+            int talentPointsLeft,
+            std::vector<std::pair<std::bitset<128>, int>>& combinations,
+            int& allCombinations
+        );
+
+        template<int... TalentIndices>
+        static constexpr std::array<VisitFunction, N> createVisitTable(std::integer_sequence<int, TalentIndices...>) {
+            return { &visitTalent<TalentIndices>... };
+        }
+
+        static constexpr std::array<VisitFunction, N> visitTable = createVisitTable(std::make_integer_sequence<int, N>());
+
+        static constexpr bool hasGates() {
+            for (int i = 0; i < N; i++) {
+                if (DAG.pointsRequired[i] > 0)
+                    return true;
+            }
+            return false;
+        }
+
+        static std::vector<std::pair<std::bitset<128>, int>> countConfigurations(int talentPoints, int& allCombinations) {
+            std::vector<std::pair<std::bitset<128>, int>> combinations;
+            allCombinations = 0;
+            if (talentPoints < 1)
+                return combinations;
+            uint64_t rootMask = DAG.rootCount == 64 ? ~0ULL : (1ULL << DAG.rootCount) - 1;
+            for (int i = 0; i < DAG.rootCount; i++) {
+                if (DAG.pointsRequired[i] == 0) {
+                    visitTable[i](0, rootMask, 1, 0, talentPoints, combinations, allCombinations);
+                }
+            }
+            return combinations;
+        }
+    };
+
+    template<const auto& DAG>
+    template<int TalentIndex>
+    void StaticTreeCounter<DAG>::visitTalent(
+        uint64_t visitedTalents,
+        uint64_t possibleTalents,
+        int currentMultiplier,
+        int talentPointsSpent,
+        int talentPointsLeft,
+        std::vector<std::pair<std::bitset<128>, int>>& combinations,
+        int& allCombinations
+    ) {
+        //do combination housekeeping
+        WTT_TELEMETRY_COUNT(nodesVisited);
+        visitedTalents |= 1ULL << TalentIndex;
+        talentPointsSpent += 1;
+        talentPointsLeft -= 1;
+        if constexpr (DAG.multipliers[TalentIndex] != 1) {
+            currentMultiplier *= DAG.multipliers[TalentIndex];
+        }
+        //check if path is complete
+        if (talentPointsLeft == 0) {
+            WTT_TELEMETRY_COUNT(emittedBuilds);
+            combinations.push_back(std::pair<std::bitset<128>, int>(visitedTalents, currentMultiplier));
+            allCombinations += currentMultiplier;
+            return;
+        }
+        //check if path can be finished
+        if (N - TalentIndex - 1 < talentPointsLeft) {
+            WTT_TELEMETRY_COUNT(prunes);
+            return;
+        }
+        possibleTalents |= DAG.childMasks[TalentIndex];
+        uint64_t nextTalents = TalentIndex == 63 ? 0 : possibleTalents & (~0ULL << (TalentIndex + 1));
+        while (nextTalents) {
+            int nextTalent = std::countr_zero(nextTalents);
+            nextTalents &= nextTalents - 1;
+            if constexpr (hasGates()) {
+                if (talentPointsSpent < DAG.pointsRequired[nextTalent]) {
+                    WTT_TELEMETRY_COUNT(gateRejections);
+                    continue;
+                }
+            }
+            visitTable[nextTalent](visitedTalents, possibleTalents, currentMultiplier, talentPointsSpent, talentPointsLeft, combinations, allCombinations);
+        }
+    }
+
+    void staticCombinationCount(int points, int repetitions);
+}
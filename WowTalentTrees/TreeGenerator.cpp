@@ -0,0 +1,189 @@
+#include "TreeGenerator.h"
+
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <cmath>
+
+namespace WowTalentTrees {
+    /*
+    Helper functions for random numbers. std::mt19937 is fully specified by the standard whereas the std distributions are not, using the
+    raw engine output keeps generated trees identical between compilers.
+    */
+    int getRandomInt(std::mt19937& rng, int low, int high) {
+        return low + static_cast<int>(rng() % static_cast<uint32_t>(high - low + 1));
+    }
+    double getRandomReal(std::mt19937& rng) {
+        return rng() / 4294967296.0;
+    }
+
+    /*
+    Talent names are "R<row><column letter>", names never end with a digit so the switch suffix in talent strings (see addTalentAndChildrenToMap)
+    can not create duplicate keys.
+    */
+    std::string getGeneratedTalentName(int row, int column) {
+        return "R" + std::to_string(row) + static_cast<char>('A' + column);
+    }
+
+    /*
+    Creates a random tree in the representation string format of parseTree.
+    */
+    std::string generateTreeString(const TreeGeneratorSettings& settings) {
+        if (settings.nodeCount < 1 || settings.nodeCount > 256)
+            throw std::invalid_argument("Node count has to be in [1, 256]");
+        if (settings.rowWidth < 1 || settings.rowWidth > 26)
+            throw std::invalid_argument("Row width has to be in [1, 26]");
+        if (settings.minFanIn < 1 || settings.maxFanIn < settings.minFanIn || settings.maxFanOut < 1)
+            throw std::invalid_argument("Fan in has to be >= 1 and <= max fan in, fan out has to be >= 1");
+        std::mt19937 rng(settings.seed);
+
+        //row sizes: few roots like the real trees, then rows between half and full width
+        std::vector<int> rowSizes;
+        int nodesLeft = settings.nodeCount;
+        while (nodesLeft > 0) {
+            int rowSize = rowSizes.size() == 0 ?
+                getRandomInt(rng, 1, std::min(3, settings.rowWidth)) :
+                getRandomInt(rng, (settings.rowWidth + 1) / 2, settings.rowWidth);
+            rowSize = std::min(rowSize, nodesLeft);
+            rowSizes.push_back(rowSize);
+            nodesLeft -= rowSize;
+        }
+
+        //connect every talent to the closest talents (column position scaled to the row sizes) of the previous row
+        std::vector<std::vector<std::vector<int>>> parents(rowSizes.size());
+        std::vector<std::vector<std::vector<int>>> children(rowSizes.size());
+        for (int row = 0; row < rowSizes.size(); row++) {
+            parents[row].resize(rowSizes[row]);
+            children[row].resize(rowSizes[row]);
+        }
+        for (int row = 1; row < rowSizes.size(); row++) {
+            int previousSize = rowSizes[row - 1];
+            for (int column = 0; column < rowSizes[row]; column++) {
+                double position = rowSizes[row] > 1 ? column * (previousSize - 1) / static_cast<double>(rowSizes[row] - 1) : (previousSize - 1) / 2.0;
+                std::vector<std::pair<double, int>> candidates;
+                for (int p = 0; p < previousSize; p++) {
+                    candidates.push_back({ std::abs(p - position) + 1.5 * getRandomReal(rng), p });
+                }
+                std::sort(candidates.begin(), candidates.end());
+                int fanIn = getRandomInt(rng, settings.minFanIn, std::min(settings.maxFanIn, previousSize));
+                for (auto& candidate : candidates) {
+                    if (parents[row][column].size() == fanIn)
+                        break;
+                    if (children[row - 1][candidate.second].size() < settings.maxFanOut) {
+                        parents[row][column].push_back(candidate.second);
+                        children[row - 1][candidate.second].push_back(column);
+                    }
+                }
+                if (parents[row][column].size() == 0) {
+                    parents[row][column].push_back(candidates[0].second);
+                    children[row - 1][candidates[0].second].push_back(column);
+                }
+            }
+        }
+
+        std::string treeRep;
+        for (int row = 0; row < rowSizes.size(); row++) {
+            int pointsRequired = 0;
+            for (auto& gate : settings.gates) {
+                if (gate.first == row)
+                    pointsRequired = gate.second;
+            }
+            for (int column = 0; column < rowSizes[row]; column++) {
+                std::string maxPoints;
+                int talentType;
+                if (getRandomReal(rng) < settings.switchFraction) {
+                    talentType = static_cast<int>(TalentType::SWITCH);
+                    maxPoints = "1_0";
+                }
+                else if (settings.maxRanks > 1 && getRandomReal(rng) < settings.multiRankFraction) {
+                    talentType = static_cast<int>(TalentType::PASSIVE);
+                    maxPoints = std::to_string(getRandomInt(rng, 2, settings.maxRanks));
+                }
+                else {
+                    talentType = getRandomInt(rng, 0, 1);
+                    maxPoints = "1";
+                }
+                if (pointsRequired > 0) {
+                    maxPoints += "@" + std::to_string(pointsRequired);
+                }
+                treeRep += getGeneratedTalentName(row, column) + "." + std::to_string(talentType) + ":" + maxPoints + "-";
+                for (int i = 0; i < parents[row][column].size(); i++) {
+                    treeRep += (i > 0 ? "," : "") + getGeneratedTalentName(row - 1, parents[row][column][i]);
+                }
+                treeRep += "+";
+                for (int i = 0; i < children[row][column].size(); i++) {
+                    treeRep += (i > 0 ? "," : "") + getGeneratedTalentName(row + 1, children[row][column][i]);
+                }
+                treeRep += ";";
+            }
+        }
+        return treeRep;
+    }
+
+    /*
+    Creates a random tree that can directly be used by the counters.
+    */
+    TalentTree generateTree(const TreeGeneratorSettings& settings) {
+        TalentTree tree = parseTree(generateTreeString(settings));
+        tree.name = "synthetic_" + std::to_string(settings.seed) + "_" + std::to_string(settings.nodeCount);
+        return tree;
+    }
+
+    /*
+    Scaling benchmark on synthetic trees: sweeps the tree size (single rank talents only, so node count = expanded talent count) and the density
+    (max fan in) and times the single N and the 1 up to N fast counters. Prints one csv line per run.
+    */
+    void syntheticTreeScalingCount(int points, uint32_t seed) {
+        std::vector<TreeGeneratorSettings> sweep;
+        for (int nodeCount = 32; nodeCount <= 64; nodeCount += 8) {
+            TreeGeneratorSettings settings;
+            settings.seed = seed;
+            settings.nodeCount = nodeCount;
+            settings.multiRankFraction = 0.0;
+            sweep.push_back(settings);
+        }
+        for (int maxFanIn = 1; maxFanIn <= 4; maxFanIn++) {
+            TreeGeneratorSettings settings;
+            settings.seed = seed;
+            settings.nodeCount = 48;
+            settings.maxFanIn = maxFanIn;
+            settings.maxFanOut = maxFanIn + 1;
+            settings.multiRankFraction = 0.0;
+            sweep.push_back(settings);
+        }
+
+        std::vector<std::string> results;
+        for (auto& settings : sweep) {
+            //talents are shared between tree copies and the counters modify them, every count needs a freshly generated tree
+            TalentTree expandedTree = generateTree(settings);
+            expandTreeTalents(expandedTree);
+            TreeDAGInfo sortedTreeDAG = createSortedMinimalDAG(expandedTree);
+            size_t edgeCount = 0;
+            for (auto& talent : sortedTreeDAG.minimalTreeDAG) {
+                edgeCount += talent.size() - 1;
+            }
+            std::string prefix = std::to_string(settings.nodeCount) + "," + std::to_string(sortedTreeDAG.sortedTalents.size()) + "," + std::to_string(edgeCount) + ","
+                + std::to_string(settings.maxFanIn) + "," + std::to_string(points) + ",";
+
+            TalentTree tree = generateTree(settings);
+            tree.unspentTalentPoints = points;
+            TalentTree parallelTree = generateTree(settings);
+            parallelTree.unspentTalentPoints = points;
+            auto t1 = std::chrono::high_resolution_clock::now();
+            size_t fastCount = countConfigurationsFast(tree).size();
+            auto t2 = std::chrono::high_resolution_clock::now();
+            size_t parallelCount = countConfigurationsFastParallel(parallelTree)[points - 1].size();
+            auto t3 = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double, std::milli> fastTime = t2 - t1;
+            std::chrono::duration<double, std::milli> parallelTime = t3 - t2;
+            results.push_back(prefix + "fast," + std::to_string(fastTime.count()) + "," + std::to_string(fastCount));
+            results.push_back(prefix + "fastParallel," + std::to_string(parallelTime.count()) + "," + std::to_string(parallelCount));
+        }
+        std::cout << "nodes,expandedTalents,edges,maxFanIn,points,engine,ms,combinations" << std::endl;
+        for (auto& result : results) {
+            std::cout << result << std::endl;
+        }
+    }
+}
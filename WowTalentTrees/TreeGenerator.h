@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "WowTalentTrees.h"
+
+namespace WowTalentTrees {
+    /*
+    Settings of the synthetic tree generator. Trees are built row by row (like the real trees), every talent of a row has parents in the previous row only,
+    row 0 talents are the roots. The same settings (incl. seed) always create the same tree string.
+    NOTE: the fast counters only support trees with at most 64 talents after expansion (sum of max points), larger trees are meant for the legacy
+    counter and for the tree tooling itself.
+    */
+    struct TreeGeneratorSettings {
+        uint32_t seed = 0;
+        //intended range 32-256
+        int nodeCount = 40;
+        //max talents per row (at most 26, columns are named A-Z)
+        int rowWidth = 4;
+        int minFanIn = 1;
+        int maxFanIn = 2;
+        //soft limit, exceeded only if a talent would not get any parent otherwise
+        int maxFanOut = 3;
+        double multiRankFraction = 0.3;
+        int maxRanks = 3;
+        double switchFraction = 0.1;
+        //(row, points required) pairs, every talent of the row gets the gate
+        std::vector<std::pair<int, int>> gates;
+    };
+
+    std::string generateTreeString(const TreeGeneratorSettings& settings);
+    TalentTree generateTree(const TreeGeneratorSettings& settings);
+    std::string getGeneratedTalentName(int row, int column);
+    void syntheticTreeScalingCount(int points, uint32_t seed);
+}
@@ -0,0 +1,313 @@
+#include "TreeRenderer.h"
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+#include <chrono>
+
+namespace WowTalentTrees {
+    constexpr int svgCellSize = 100;
+    constexpr int svgNodeSize = 64;
+    constexpr int svgMargin = 20;
+    constexpr int svgTitleHeight = 40;
+
+    /*
+    Helper function that recursively collects all talents of a tree in order of appearance (each talent once).
+    */
+    void collectLayoutTalents(std::shared_ptr<Talent> talent, TreeLayout& layout, std::vector<std::shared_ptr<Talent>>& talents) {
+        if (layout.nodeIndices.count(talent->index))
+            return;
+        layout.nodeIndices[talent->index] = static_cast<int>(talents.size());
+        talents.push_back(talent);
+        for (auto& child : talent->children) {
+            collectLayoutTalents(child, layout, talents);
+        }
+    }
+
+    /*
+    Parses the grid position out of a talent index, returns false if the index has neither the "A1" nor the "R0A" format.
+    */
+    bool getGridPosition(const std::string& index, int& row, int& column) {
+        auto isDigits = [](const std::string& s) {
+            return s.size() > 0 && std::all_of(s.begin(), s.end(), [](char c) { return c >= '0' && c <= '9'; });
+        };
+        if (index.size() >= 3 && index[0] == 'R' && index.back() >= 'A' && index.back() <= 'Z' && isDigits(index.substr(1, index.size() - 2))) {
+            row = std::stoi(index.substr(1, index.size() - 2));
+            column = index.back() - 'A';
+            return true;
+        }
+        if (index.size() >= 2 && index[0] >= 'A' && index[0] <= 'Z' && isDigits(index.substr(1))) {
+            row = index[0] - 'A';
+            column = std::stoi(index.substr(1)) - 1;
+            return column >= 0;
+        }
+        return false;
+    }
+
+    /*
+    Creates the layout of a (not expanded) tree.
+    */
+    TreeLayout createTreeLayout(TalentTree tree) {
+        TreeLayout layout;
+        layout.name = tree.name;
+        std::vector<std::shared_ptr<Talent>> talents;
+        for (auto& root : tree.talentRoots) {
+            collectLayoutTalents(root, layout, talents);
+        }
+        bool hasGrid = true;
+        for (auto& talent : talents) {
+            TreeLayoutNode node;
+            node.index = talent->index;
+            node.type = talent->type;
+            node.maxPoints = talent->maxPoints;
+            for (auto& child : talent->children) {
+                node.children.push_back(layout.nodeIndices[child->index]);
+            }
+            hasGrid = getGridPosition(node.index, node.row, node.column) && hasGrid;
+            layout.nodes.push_back(node);
+        }
+        if (!hasGrid) {
+            //talents are collected depth first, a talent can appear before one of its parents so rows are relaxed until nothing changes
+            for (auto& node : layout.nodes) {
+                node.row = 0;
+            }
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (auto& node : layout.nodes) {
+                    for (int child : node.children) {
+                        if (layout.nodes[child].row < node.row + 1) {
+                            layout.nodes[child].row = node.row + 1;
+                            changed = true;
+                        }
+                    }
+                }
+            }
+            std::unordered_map<int, int> rowSizes;
+            for (auto& node : layout.nodes) {
+                node.column = rowSizes[node.row]++;
+            }
+        }
+        for (auto& node : layout.nodes) {
+            layout.rows = std::max(layout.rows, node.row + 1);
+            layout.columns = std::max(layout.columns, node.column + 1);
+        }
+        return layout;
+    }
+
+    /*
+    Helper function that escapes text for SVG content and attributes.
+    */
+    std::string escapeSvgText(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            switch (c) {
+            case '&': escaped += "&amp;"; break;
+            case '<': escaped += "&lt;"; break;
+            case '>': escaped += "&gt;"; break;
+            case '"': escaped += "&quot;"; break;
+            default: escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    /*
+    Helper function that returns the same fill colors as getFillColor (graphviz color names as hex values).
+    */
+    std::string getSvgFillColor(const TreeLayoutNode& node, int points, int choice) {
+        if (points == 0)
+            return "#ffffff";
+        else if (choice < 0)
+            return points == node.maxPoints ? "#eead0e" : "#66cd00";
+        else if (choice == 0)
+            return "#66cdaa";
+        else if (choice == 1)
+            return "#ff7f50";
+        else
+            return "#ff00ff";
+    }
+
+    /*
+    Renders a tree with the given points and selected choices (-1 for regular talents, see getLayoutChoices) per layout node as a standalone SVG document.
+    Shapes, colors and labels are the same as in visualizeTree.
+    */
+    std::string renderTreeSvg(const TreeLayout& layout, const std::vector<int>& points, const std::vector<int>& choices, std::string title) {
+        if (points.size() != layout.nodes.size() || choices.size() != layout.nodes.size())
+            throw std::invalid_argument("Number of points or choices and layout nodes differ");
+        int width = 2 * svgMargin + std::max(layout.columns, 1) * svgCellSize;
+        int height = 2 * svgMargin + svgTitleHeight + std::max(layout.rows, 1) * svgCellSize;
+        auto getCenterX = [](const TreeLayoutNode& node) { return svgMargin + node.column * svgCellSize + svgCellSize / 2; };
+        auto getCenterY = [](const TreeLayoutNode& node) { return svgMargin + svgTitleHeight + node.row * svgCellSize + svgCellSize / 2; };
+        const int half = svgNodeSize / 2;
+
+        std::ostringstream svg;
+        svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height << "\" viewBox=\"0 0 " << width << " " << height << "\" font-family=\"Arial\">\n";
+        svg << "<defs><marker id=\"arrow\" viewBox=\"0 0 10 10\" refX=\"10\" refY=\"5\" markerWidth=\"6\" markerHeight=\"6\" orient=\"auto\"><path d=\"M0,0 L10,5 L0,10 z\"/></marker></defs>\n";
+        svg << "<rect width=\"100%\" height=\"100%\" fill=\"#ffffff\"/>\n";
+        svg << "<text x=\"" << width / 2 << "\" y=\"" << svgMargin + svgTitleHeight / 2 << "\" text-anchor=\"middle\" font-size=\"18\">" << escapeSvgText(title) << "</text>\n";
+        //connections first so nodes are drawn on top
+        svg << "<g stroke=\"#000000\" stroke-width=\"1.5\">\n";
+        for (auto& node : layout.nodes) {
+            for (int child : node.children) {
+                const TreeLayoutNode& childNode = layout.nodes[child];
+                svg << "<line x1=\"" << getCenterX(node) << "\" y1=\"" << getCenterY(node) + half << "\" x2=\"" << getCenterX(childNode) << "\" y2=\"" << getCenterY(childNode) - half
+                    << "\" marker-end=\"url(#arrow)\"/>\n";
+            }
+        }
+        svg << "</g>\n";
+        svg << "<g stroke=\"#000000\" stroke-width=\"1.5\" font-size=\"13\" text-anchor=\"middle\">\n";
+        for (int i = 0; i < layout.nodes.size(); i++) {
+            const TreeLayoutNode& node = layout.nodes[i];
+            int x = getCenterX(node);
+            int y = getCenterY(node);
+            std::string fill = getSvgFillColor(node, points[i], choices[i]);
+            switch (node.type) {
+            case TalentType::PASSIVE:
+                svg << "<circle cx=\"" << x << "\" cy=\"" << y << "\" r=\"" << half << "\" fill=\"" << fill << "\"/>\n";
+                break;
+            case TalentType::SWITCH: {
+                //regular octagon with flat top/bottom
+                const int edge = svgNodeSize * 29 / 70;
+                const int inner = edge / 2;
+                svg << "<polygon points=\"" << x - inner << "," << y - half << " " << x + inner << "," << y - half << " " << x + half << "," << y - inner << " "
+                    << x + half << "," << y + inner << " " << x + inner << "," << y + half << " " << x - inner << "," << y + half << " "
+                    << x - half << "," << y + inner << " " << x - half << "," << y - inner << "\" fill=\"" << fill << "\"/>\n";
+                break;
+            }
+            default:
+                svg << "<rect x=\"" << x - half << "\" y=\"" << y - half << "\" width=\"" << svgNodeSize << "\" height=\"" << svgNodeSize << "\" fill=\"" << fill << "\"/>\n";
+            }
+            svg << "<text x=\"" << x << "\" y=\"" << y << "\" stroke=\"none\">" << escapeSvgText(node.index) << " " << points[i] << "/" << node.maxPoints;
+            if (choices[i] >= 0) {
+                std::string label = choices[i] == 0 ? "left" : choices[i] == 1 ? "right" : "choice " + std::to_string(choices[i] + 1);
+                svg << "<tspan x=\"" << x << "\" dy=\"15\">" << label << "</tspan>";
+            }
+            svg << "</text>\n";
+        }
+        svg << "</g>\n";
+        svg << "</svg>\n";
+        return svg.str();
+    }
+
+    /*
+    Helper function that recursively collects the points and switch states of all talents of a tree into points and choices per layout node.
+    */
+    void collectLayoutPoints(std::shared_ptr<Talent> talent, const TreeLayout& layout, std::vector<int>& points, std::vector<int>& choices) {
+        int node = layout.nodeIndices.at(talent->index);
+        points[node] = talent->points;
+        choices[node] = talent->talentSwitch;
+        for (auto& child : talent->children) {
+            collectLayoutPoints(child, layout, points, choices);
+        }
+    }
+
+    /*
+    Renders a filled out (not expanded) tree, e.g. the result of fillOutTreeWithBinaryIndexToString, with the points of its talents.
+    */
+    std::string renderTreeSvg(TalentTree tree, std::string title) {
+        TreeLayout layout = createTreeLayout(tree);
+        std::vector<int> points(layout.nodes.size(), 0);
+        std::vector<int> choices(layout.nodes.size(), -1);
+        for (auto& root : tree.talentRoots) {
+            collectLayoutPoints(root, layout, points, choices);
+        }
+        return renderTreeSvg(layout, points, choices, title);
+    }
+
+    /*
+    Translates a uint64 index of the sorted DAG (expanded talents "INDEX_RANK", see expandTalentAndAdvance) into points per layout node.
+    */
+    std::vector<int> getLayoutPoints(const TreeLayout& layout, const TreeDAGInfo& sortedTreeDAG, uint64_t comb) {
+        std::vector<int> points(layout.nodes.size(), 0);
+        for (int i = 0; i < sortedTreeDAG.sortedTalents.size(); i++) {
+            if (comb & (1ULL << i)) {
+                std::string index = splitString(sortedTreeDAG.sortedTalents[i]->index, "_")[0];
+                auto node = layout.nodeIndices.find(index);
+                if (node == layout.nodeIndices.end())
+                    throw std::logic_error("Talent " + index + " is not part of the layout");
+                points[node->second] += 1;
+            }
+        }
+        return points;
+    }
+
+    /*
+    Translates the choice suffix of a concrete build (see ChoiceLayout) into the selected choice per layout node, -1 for regular and unselected talents.
+    */
+    std::vector<int> getLayoutChoices(const TreeLayout& layout, const TreeDAGInfo& sortedTreeDAG, const ChoiceLayout& choiceLayout, const ChoiceBuild& build) {
+        std::vector<int> choices(layout.nodes.size(), -1);
+        for (int talentIndex : choiceLayout.choiceTalents) {
+            int choice = getChoice(choiceLayout, build, talentIndex);
+            if (choice >= 0) {
+                std::string index = splitString(sortedTreeDAG.sortedTalents[talentIndex]->index, "_")[0];
+                auto node = layout.nodeIndices.find(index);
+                if (node == layout.nodeIndices.end())
+                    throw std::logic_error("Talent " + index + " is not part of the layout");
+                choices[node->second] = choice;
+            }
+        }
+        return choices;
+    }
+
+    /*
+    Renders every concrete build (switch talents with the side of their choice bits) into "<directory>/<prefix>_<position>.svg" in parallel and returns
+    the number of written files.
+    */
+    size_t renderBuildSvgs(
+        const TreeLayout& layout,
+        const TreeDAGInfo& sortedTreeDAG,
+        const ChoiceLayout& choiceLayout,
+        const std::vector<ChoiceBuild>& builds,
+        std::string directory,
+        std::string prefix
+    ) {
+        std::filesystem::create_directories(directory);
+        int64_t buildCount = static_cast<int64_t>(builds.size());
+        std::vector<char> written(builds.size(), 0);
+#pragma omp parallel for schedule(dynamic, 16)
+        for (int64_t i = 0; i < buildCount; i++) {
+            std::vector<int> points = getLayoutPoints(layout, sortedTreeDAG, builds[i].mask);
+            std::vector<int> choices = getLayoutChoices(layout, sortedTreeDAG, choiceLayout, builds[i]);
+            std::string svg = renderTreeSvg(layout, points, choices, layout.name + " " + prefix + " " + std::to_string(i));
+            std::filesystem::path path = std::filesystem::path(directory) / (prefix + "_" + std::to_string(i) + ".svg");
+            std::ofstream f(path, std::ios::binary);
+            f << svg;
+            written[i] = static_cast<char>(f.good());
+        }
+        size_t writtenCount = std::count(written.begin(), written.end(), static_cast<char>(1));
+        if (writtenCount != builds.size())
+            std::cout << "Could not write " << builds.size() - writtenCount << " of " << builds.size() << " SVG files to " << directory << std::endl;
+        return writtenCount;
+    }
+
+    /*
+    Renders (up to maxBuilds) builds of the default tree with the given number of talent points and prints the rendering time.
+    */
+    void renderBuildSvgBatch(int points, size_t maxBuilds, std::string directory) {
+        TalentTree tree = getDefaultTree();
+        tree.unspentTalentPoints = points;
+        std::vector<std::pair<std::bitset<128>, int>> combinations = countConfigurationsFast(tree);
+        //every base build has at least one concrete build, so the first maxBuilds base builds are enough
+        if (combinations.size() > maxBuilds)
+            combinations.resize(maxBuilds);
+        //counters mutate the talents of the tree, layout and DAG need a fresh one
+        TalentTree layoutTree = getDefaultTree();
+        TreeLayout layout = createTreeLayout(layoutTree);
+        expandTreeTalents(layoutTree);
+        TreeDAGInfo sortedTreeDAG = createSortedMinimalDAG(layoutTree);
+        ChoiceLayout choiceLayout = createChoiceLayout(sortedTreeDAG);
+        std::vector<ChoiceBuild> builds = expandChoiceBuilds(choiceLayout, combinations);
+        if (builds.size() > maxBuilds)
+            builds.resize(maxBuilds);
+
+        auto t1 = std::chrono::high_resolution_clock::now();
+        size_t written = renderBuildSvgs(layout, sortedTreeDAG, choiceLayout, builds, directory, "build" + std::to_string(points));
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> ms_double = t2 - t1;
+        std::cout << "Rendered " << written << " builds to " << directory << " in " << ms_double.count() << " ms" << std::endl;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "WowTalentTrees.h"
+#include "ChoiceExpansion.h"
+
+namespace WowTalentTrees {
+    /*
+    Talent of a (not expanded) tree with its position in the tree grid.
+    */
+    struct TreeLayoutNode {
+        std::string index;
+        TalentType type = TalentType::ACTIVE;
+        int maxPoints = 0;
+        int row = 0;
+        int column = 0;
+        std::vector<int> children;
+    };
+
+    /*
+    Fixed layout of a tree for the SVG renderer. Positions come from the talent indices: "A1" (row letter, column number starting at 1, see Talent)
+    or "R0A" (row number, column letter, see getGeneratedTalentName). If any index has neither format, rows are the longest path from a root
+    and columns the order of appearance in the row. The layout only depends on the tree, every build of the tree is rendered with the same layout.
+    */
+    struct TreeLayout {
+        std::string name;
+        int rows = 0;
+        int columns = 0;
+        std::vector<TreeLayoutNode> nodes;
+        std::unordered_map<std::string, int> nodeIndices;
+    };
+
+    TreeLayout createTreeLayout(TalentTree tree);
+    bool getGridPosition(const std::string& index, int& row, int& column);
+    std::string renderTreeSvg(const TreeLayout& layout, const std::vector<int>& points, const std::vector<int>& choices, std::string title);
+    std::string renderTreeSvg(TalentTree tree, std::string title);
+    std::vector<int> getLayoutPoints(const TreeLayout& layout, const TreeDAGInfo& sortedTreeDAG, uint64_t comb);
+    std::vector<int> getLayoutChoices(const TreeLayout& layout, const TreeDAGInfo& sortedTreeDAG, const ChoiceLayout& choiceLayout, const ChoiceBuild& build);
+    size_t renderBuildSvgs(
+        const TreeLayout& layout,
+        const TreeDAGInfo& sortedTreeDAG,
+        const ChoiceLayout& choiceLayout,
+        const std::vector<ChoiceBuild>& builds,
+        std::string directory,
+        std::string prefix
+    );
+    void renderBuildSvgBatch(int points, size_t maxBuilds, std::string directory);
+}
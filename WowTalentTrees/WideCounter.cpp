@@ -0,0 +1,260 @@
+#include "WideCounter.h"
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <deque>
+#include <chrono>
+#include <bit>
+
+namespace WowTalentTrees {
+    //histogram entries per budget: 0 up to 64 switch talents
+    constexpr int switchHistogramWidth = 65;
+
+    /*
+    Minimal bit mask version of the sorted DAG for the counting kernel.
+    */
+    struct WideCountDAG {
+        int talentCount = 0;
+        std::vector<uint64_t> childMasks;
+        std::vector<int> pointsRequired;
+        std::vector<int> switchTalents;
+    };
+
+    /*
+    State of the counting kernel before a talent is visited (same meaning as the arguments of visitTalent, possible talents as bit mask).
+    */
+    struct WideStartPoint {
+        int talentIndex = 0;
+        uint64_t possibleTalents = 0;
+        int switchTalents = 0;
+        int talentPointsSpent = 0;
+        int talentPointsLeft = 0;
+    };
+
+    UInt128 addUInt128(UInt128 a, UInt128 b, CountOverflowMode mode, bool& saturated) {
+        UInt128 sum;
+        sum.low = a.low + b.low;
+        uint64_t carry = sum.low < a.low ? 1 : 0;
+        uint64_t high = a.high + b.high;
+        bool overflow = high < a.high;
+        sum.high = high + carry;
+        overflow = overflow || sum.high < high;
+        if (overflow) {
+            if (mode == CountOverflowMode::CHECKED)
+                throw std::overflow_error("128 bit count overflow");
+            saturated = true;
+            return { ~0ULL, ~0ULL };
+        }
+        return sum;
+    }
+
+    /*
+    value * 2^shift for shift in [0, 64], can't overflow for the histogram entries of the counter.
+    */
+    UInt128 shiftLeftUInt128(uint64_t value, int shift) {
+        if (shift < 0 || shift > 64)
+            throw std::invalid_argument("Shift has to be in [0, 64]");
+        if (shift == 0)
+            return { value, 0 };
+        if (shift == 64)
+            return { 0, value };
+        return { value << shift, value >> (64 - shift) };
+    }
+
+    uint64_t addUInt64(uint64_t a, uint64_t b, CountOverflowMode mode, bool& saturated) {
+        uint64_t sum = a + b;
+        if (sum < a) {
+            if (mode == CountOverflowMode::CHECKED)
+                throw std::overflow_error("64 bit count overflow");
+            saturated = true;
+            return ~0ULL;
+        }
+        return sum;
+    }
+
+    /*
+    Narrows a count to 64 bit (e.g. for BuildStore or ShardResult counts).
+    */
+    uint64_t getCount64(UInt128 count, CountOverflowMode mode, bool& saturated) {
+        if (count.high != 0) {
+            if (mode == CountOverflowMode::CHECKED)
+                throw std::overflow_error("Count " + countToString(count) + " does not fit into 64 bit");
+            saturated = true;
+            return ~0ULL;
+        }
+        return count.low;
+    }
+
+    /*
+    Decimal representation of a 128 bit count (long division by 10 on 32 bit limbs).
+    */
+    std::string countToString(UInt128 count) {
+        uint32_t limbs[4] = {
+            static_cast<uint32_t>(count.high >> 32), static_cast<uint32_t>(count.high),
+            static_cast<uint32_t>(count.low >> 32), static_cast<uint32_t>(count.low)
+        };
+        std::string digits;
+        while (limbs[0] != 0 || limbs[1] != 0 || limbs[2] != 0 || limbs[3] != 0) {
+            uint64_t remainder = 0;
+            for (auto& limb : limbs) {
+                uint64_t current = (remainder << 32) | limb;
+                limb = static_cast<uint32_t>(current / 10);
+                remainder = current % 10;
+            }
+            digits += static_cast<char>('0' + remainder);
+        }
+        if (digits.size() == 0)
+            return "0";
+        std::reverse(digits.begin(), digits.end());
+        return digits;
+    }
+
+    /*
+    Helper function that does the housekeeping of a visited talent (see visitTalent) and counts the build. Returns false if the path is complete
+    or can't be finished.
+    */
+    inline bool recordTalentWide(const WideCountDAG& dag, WideStartPoint& sp, bool allBudgets, uint64_t* histogram) {
+        sp.talentPointsSpent += 1;
+        sp.talentPointsLeft -= 1;
+        sp.switchTalents += dag.switchTalents[sp.talentIndex];
+        if (allBudgets || sp.talentPointsLeft == 0) {
+            histogram[(sp.talentPointsSpent - 1) * switchHistogramWidth + sp.switchTalents] += 1;
+        }
+        if (sp.talentPointsLeft == 0)
+            return false;
+        //only the single budget count can stop early, all budgets count every shorter path as well
+        if (!allBudgets && dag.talentCount - sp.talentIndex - 1 < sp.talentPointsLeft)
+            return false;
+        sp.possibleTalents |= dag.childMasks[sp.talentIndex];
+        return true;
+    }
+
+    /*
+    Helper function that returns the talents that can be visited after the current one (possible talents with a higher index).
+    */
+    inline uint64_t getNextTalentsWide(const WideStartPoint& sp) {
+        return sp.talentIndex == 63 ? 0 : sp.possibleTalents & (~0ULL << (sp.talentIndex + 1));
+    }
+
+    /*
+    Counting kernel, same search as visitTalent/visitTalentParallel but nothing is stored except the switch histogram of the start point.
+    */
+    void visitTalentWide(const WideCountDAG& dag, WideStartPoint sp, bool allBudgets, uint64_t* histogram) {
+        if (!recordTalentWide(dag, sp, allBudgets, histogram))
+            return;
+        uint64_t nextTalents = getNextTalentsWide(sp);
+        while (nextTalents) {
+            int nextTalent = std::countr_zero(nextTalents);
+            nextTalents &= nextTalents - 1;
+            if (sp.talentPointsSpent < dag.pointsRequired[nextTalent])
+                continue;
+            WideStartPoint child = sp;
+            child.talentIndex = nextTalent;
+            visitTalentWide(dag, child, allBudgets, histogram);
+        }
+    }
+
+    /*
+    Counts all builds of a tree (single budget or all budgets) in parallel. Every start point counts into its own histogram, the histograms are reduced
+    after the parallel section with the overflow mode of the settings.
+    */
+    WideCountResult countConfigurationsWide(TalentTree tree, const WideCountSettings& settings) {
+        int talentPoints = tree.unspentTalentPoints;
+        if (talentPoints < 1)
+            throw std::invalid_argument("Talent points have to be at least 1");
+        expandTreeTalents(tree);
+        TreeDAGInfo sortedTreeDAG = createSortedMinimalDAG(tree);
+        if (sortedTreeDAG.sortedTalents.size() > 64)
+            throw std::logic_error("Number of talents exceeds 64, need different indexing type instead of uint64");
+        WideCountDAG dag;
+        dag.talentCount = static_cast<int>(sortedTreeDAG.sortedTalents.size());
+        for (int i = 0; i < dag.talentCount; i++) {
+            uint64_t childMask = 0;
+            for (int j = 1; j < sortedTreeDAG.minimalTreeDAG[i].size(); j++) {
+                childMask |= 1ULL << sortedTreeDAG.minimalTreeDAG[i][j];
+            }
+            dag.childMasks.push_back(childMask);
+            dag.pointsRequired.push_back(sortedTreeDAG.sortedTalents[i]->pointsRequired);
+            //the histogram is indexed by the number of switch talents, every switch talent has to double the count
+            if (sortedTreeDAG.minimalTreeDAG[i][0] != 1 && sortedTreeDAG.minimalTreeDAG[i][0] != 2)
+                throw std::invalid_argument("Wide counter only supports switch talents with 2 choices");
+            dag.switchTalents.push_back(sortedTreeDAG.minimalTreeDAG[i][0] == 2 ? 1 : 0);
+        }
+
+        //split the search breadth first into independent start points (see getStartPoints), completed prefixes are counted right away
+        size_t histogramSize = static_cast<size_t>(talentPoints) * switchHistogramWidth;
+        std::vector<uint64_t> prefixHistogram(histogramSize, 0);
+        uint64_t rootMask = 0;
+        for (auto& root : sortedTreeDAG.rootIndices) {
+            rootMask |= 1ULL << root;
+        }
+        std::deque<WideStartPoint> spQ;
+        for (auto& root : sortedTreeDAG.rootIndices) {
+            if (dag.pointsRequired[root] == 0) {
+                spQ.push_back({ root, rootMask, 0, 0, talentPoints });
+            }
+        }
+        while (spQ.size() > 0 && spQ.size() < static_cast<size_t>(settings.startPointCount)) {
+            WideStartPoint sp = spQ.front();
+            spQ.pop_front();
+            if (!recordTalentWide(dag, sp, settings.allBudgets, prefixHistogram.data()))
+                continue;
+            uint64_t nextTalents = getNextTalentsWide(sp);
+            while (nextTalents) {
+                int nextTalent = std::countr_zero(nextTalents);
+                nextTalents &= nextTalents - 1;
+                if (sp.talentPointsSpent < dag.pointsRequired[nextTalent])
+                    continue;
+                WideStartPoint child = sp;
+                child.talentIndex = nextTalent;
+                spQ.push_back(child);
+            }
+        }
+        std::vector<WideStartPoint> startPoints(spQ.begin(), spQ.end());
+
+        std::vector<std::vector<uint64_t>> threadHistograms(startPoints.size());
+        int startPointCount = static_cast<int>(startPoints.size());
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < startPointCount; i++) {
+            threadHistograms[i].resize(histogramSize, 0);
+            visitTalentWide(dag, startPoints[i], settings.allBudgets, threadHistograms[i].data());
+        }
+        threadHistograms.push_back(prefixHistogram);
+
+        WideCountResult result;
+        result.talentPoints = talentPoints;
+        result.allBudgets = settings.allBudgets;
+        result.switchHistograms.resize(talentPoints, std::vector<uint64_t>(switchHistogramWidth, 0));
+        result.buildCounts.resize(talentPoints, 0);
+        result.weightedCounts.resize(talentPoints);
+        for (int b = 0; b < talentPoints; b++) {
+            for (int k = 0; k < switchHistogramWidth; k++) {
+                uint64_t& count = result.switchHistograms[b][k];
+                for (auto& histogram : threadHistograms) {
+                    count = addUInt64(count, histogram[b * switchHistogramWidth + k], settings.overflowMode, result.saturated);
+                }
+                result.buildCounts[b] = addUInt64(result.buildCounts[b], count, settings.overflowMode, result.saturated);
+                result.weightedCounts[b] = addUInt128(result.weightedCounts[b], shiftLeftUInt128(count, k), settings.overflowMode, result.saturated);
+            }
+        }
+        return result;
+    }
+
+    void wideCombinationCount(int points, bool allBudgets) {
+        TalentTree tree = getDefaultTree();
+        tree.unspentTalentPoints = points;
+        WideCountSettings settings;
+        settings.allBudgets = allBudgets;
+
+        auto t1 = std::chrono::high_resolution_clock::now();
+        WideCountResult result = countConfigurationsWide(tree, settings);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> ms_double = t2 - t1;
+        for (int i = allBudgets ? 0 : points - 1; i < points; i++) {
+            std::cout << "Number of configurations for " << i + 1 << " talent points without switch talents: " << result.buildCounts[i]
+                << " and with : " << countToString(result.weightedCounts[i]) << std::endl;
+        }
+        std::cout << "Wide count operation time: " << ms_double.count() << " ms" << std::endl;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "WowTalentTrees.h"
+
+namespace WowTalentTrees {
+    /*
+    Portable unsigned 128 bit integer (MSVC has no __int128), only the operations the counters need.
+    */
+    struct UInt128 {
+        uint64_t low = 0;
+        uint64_t high = 0;
+    };
+
+    //CHECKED throws std::overflow_error, SATURATING clamps to the max value of the count type and sets the saturated flag of the result
+    enum class CountOverflowMode {
+        CHECKED, SATURATING
+    };
+
+    struct WideCountSettings {
+        //count all budgets 1 up to talentPoints (like countConfigurationsFastParallel) instead of only talentPoints (like countConfigurationsFast)
+        bool allBudgets = false;
+        //number of independent start points the search is split into, every start point has its own counts (no shared counter)
+        int startPointCount = 256;
+        CountOverflowMode overflowMode = CountOverflowMode::CHECKED;
+    };
+
+    /*
+    Counts of the wide counter. Builds are only counted, not stored, so any budget fits into memory. The kernel counts builds per number of
+    switch talents, a uint64 histogram entry can't overflow for trees with at most 64 talents. Counts incl. switch talent choices
+    (sum of histogram[k] * 2^k) need up to 128 bits and are only computed in the final reduction.
+    budget b holds the builds with b + 1 talent points (all budgets) or is empty except for the last one (single budget).
+    */
+    struct WideCountResult {
+        int talentPoints = 0;
+        bool allBudgets = false;
+        bool saturated = false;
+        std::vector<std::vector<uint64_t>> switchHistograms;
+        std::vector<uint64_t> buildCounts;
+        std::vector<UInt128> weightedCounts;
+    };
+
+    UInt128 addUInt128(UInt128 a, UInt128 b, CountOverflowMode mode, bool& saturated);
+    UInt128 shiftLeftUInt128(uint64_t value, int shift);
+    uint64_t addUInt64(uint64_t a, uint64_t b, CountOverflowMode mode, bool& saturated);
+    uint64_t getCount64(UInt128 count, CountOverflowMode mode, bool& saturated);
+    std::string countToString(UInt128 count);
+    WideCountResult countConfigurationsWide(TalentTree tree, const WideCountSettings& settings = WideCountSettings());
+    void wideCombinationCount(int points, bool allBudgets);
+}
@@ -1,5 +1,15 @@
 #include "WowTalentTrees.h"
 #include "BloodmalletCounter.h"
+#include "ShardedCounter.h"
+#include "EnumerationTelemetry.h"
+#include "BuildDecoder.h"
+#include "TreeGenerator.h"
+#include "DifferentialHarness.h"
+#include "StaticTreeCounter.h"
+#include "BuildValidator.h"
+#include "TreeRenderer.h"
+#include "WideCounter.h"
+#include "ChoiceExpansion.h"
 
 #include <iostream>
 #include <vector>
@@ -7,17 +17,33 @@
 #include <execution>
 #include <sstream> 
 #include <fstream>
+#include <filesystem>
 #include "Windows.h"
 #include <chrono>
 #include <thread>
 
-int main() {
+int main(int argc, char** argv) {
+    //command line mode for the multi process (sharded) enumeration, see ShardedCounter.h
+    if (argc > 1) {
+        //differential check of all counting engines, see DifferentialHarness.h
+        if (std::string(argv[1]) == "check") {
+            return WowTalentTrees::runDifferentialCommand(argc, argv);
+        }
+        return WowTalentTrees::runShardCommand(argc, argv);
+    }
+
     auto t1 = std::chrono::high_resolution_clock::now();
 
     //WowTalentTrees::bloodmalletCount(16);
     //WowTalentTrees::individualCombinationCount(30);
     WowTalentTrees::parallelCombinationCount(30);
     //WowTalentTrees::parallelCombinationCountThreaded(30);
+    //WowTalentTrees::syntheticTreeScalingCount(12, 0);
+    //WowTalentTrees::staticCombinationCount(20, 5);
+    //WowTalentTrees::buildValidatorThroughput(20, 100000000);
+    //WowTalentTrees::renderBuildSvgBatch(10, 5000, "TreesInputsOutputs/builds");
+    //WowTalentTrees::wideCombinationCount(41, false);
+    //WowTalentTrees::choiceExpansionCount(20);
 
     auto t2 = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double, std::milli> ms_double = t2 - t1;
@@ -25,51 +51,6 @@ int main() {
 }
 
 namespace WowTalentTrees {
-    // Switch talents can select/switch between 2 talents in the same slot
-    enum class TalentType {
-        ACTIVE, PASSIVE, SWITCH
-    };
-
-    /*
-    A tree has a name, (un)spent talent points and a list of root talents (talents without parents) that are the starting point
-    */
-    struct TalentTree {
-        std::string name = "defaultTree";
-        int unspentTalentPoints = 30;
-        int spentTalentPoints = 0;
-        std::vector<std::shared_ptr<Talent>> talentRoots;
-    };
-
-    /*
-    A talent has an index (scheme: https://github.com/Bloodmallet/simc_support/blob/feature/10-0-experiments/simc_support/game_data/full_tree_coordinates.jpg),
-    a name (currently not used), a type, the (max) points and a switch (might make the talent type redundant) as well as a list of all parents and children in
-    a simple graph structure.
-    */
-    struct Talent {
-        std::string index = "";
-        std::string name = "";
-        TalentType type = TalentType::ACTIVE;
-        int points = 0;
-        int maxPoints = 0;
-        int pointsRequired = 0;
-        int talentSwitch = -1;
-        std::vector<std::shared_ptr<Talent>> parents;
-        std::vector<std::shared_ptr<Talent>> children;
-    };
-
-    /*
-    This is the container for the heavily optimized, topologically sorted DAG variant of the talent tree.
-    The regular talent tree has all the meta information and easy readable/debugable structures whereas this container
-    only has integer indices with an unconnected raw list of talents for computational efficieny.
-    NOTE: The talents aren't selected (i.e. Talent::points incremented) at all but a flag is set in a uint64 which is used
-    as an indexer. There exist routines that translate from uint64 to a regular tree and in the future maybe vice versa.
-    */
-    struct TreeDAGInfo {
-        std::vector<std::vector<int>> minimalTreeDAG;
-        std::vector<std::shared_ptr<Talent>> sortedTalents;
-        std::vector<int> rootIndices;
-    };
-
     //Tree/talent helper functions
 
     void addChild(std::shared_ptr<Talent> parent, std::shared_ptr<Talent> child) {
@@ -148,8 +129,10 @@ namespace WowTalentTrees {
     }
 
     /*
-    Tree representation string is of the format "NAME.TalentType:maxPoints(_ISSWITCH)-PARENT1,PARENT2+CHILD1,CHILD2;NAME:maxPoints-....."
+    Tree representation string is of the format "NAME.TalentType:maxPoints(_ISSWITCH(#CHOICES))(@POINTSREQUIRED)-PARENT1,PARENT2+CHILD1,CHILD2;NAME:maxPoints-....."
     IMPORTANT: no error checking for strings and ISSWITCH is optional and indicates if it is a selection talent!
+    CHOICES is optional and sets the number of talents a switch talent selects from (default 2).
+    POINTSREQUIRED is optional as well and sets the talent points that have to be spent before the talent can be selected (gate).
     */
     TalentTree parseTree(std::string treeRep) {
         std::vector<std::shared_ptr<Talent>> roots;
@@ -170,6 +153,14 @@ namespace WowTalentTrees {
             }
             t->type = static_cast<TalentType>(talentType);
             std::string maxPointsAndSwitch = talentInfo.substr(talentInfo.find(":") + 1, talentInfo.find("-") - talentInfo.find(":") - 1);
+            if (maxPointsAndSwitch.find("@") != std::string::npos) {
+                t->pointsRequired = std::stoi(maxPointsAndSwitch.substr(maxPointsAndSwitch.find("@") + 1));
+                maxPointsAndSwitch = maxPointsAndSwitch.substr(0, maxPointsAndSwitch.find("@"));
+            }
+            if (maxPointsAndSwitch.find("#") != std::string::npos) {
+                t->choiceCount = std::stoi(maxPointsAndSwitch.substr(maxPointsAndSwitch.find("#") + 1));
+                maxPointsAndSwitch = maxPointsAndSwitch.substr(0, maxPointsAndSwitch.find("#"));
+            }
             if (maxPointsAndSwitch.find("_") == std::string::npos) {
                 t->maxPoints = std::stoi(maxPointsAndSwitch);
             }
@@ -232,11 +223,11 @@ namespace WowTalentTrees {
     }
 
     /*
-    Visualizes a given tree with graphviz. Needs to be installed and the paths have to exist. Generally not safe to use without careful skimming through it.
+    Visualizes a given tree as graphviz text file and as SVG image (rendered in process, graphviz is not needed) in the given directory (created if it
+    doesn't exist). Generally not safe to use without careful skimming through it.
     */
-    void visualizeTree(TalentTree tree, std::string suffix) {
+    void visualizeTree(TalentTree tree, std::string suffix, std::string directory) {
         std::cout << "Visualize tree " << tree.name << " " << suffix << std::endl;
-        std::string directory = "C:\\Users\\Tobi\\Documents\\Programming\\CodeSnippets\\WowTalentTrees\\TreesInputsOutputs";
 
         std::stringstream output;
         output << "strict digraph " << tree.name << " {\n";
@@ -255,14 +246,20 @@ namespace WowTalentTrees {
         }
         output << "}";
 
+        std::filesystem::create_directories(directory);
+        std::filesystem::path path = std::filesystem::path(directory) / ("tree_" + tree.name + suffix);
+
         //output txt file in graphviz format
         std::ofstream f;
-        f.open(directory + "\\tree_" + tree.name + suffix + ".txt");
+        f.open(path.string() + ".txt");
         f << output.str();
         f.close();
-        
-        std::string command = "\"\"C:\\Program Files\\Graphviz\\bin\\dot.exe\" -Tpng \"" + directory + "\\tree_" + tree.name + suffix + ".txt\" -o \"" + directory + "\\tree_" + tree.name + suffix + ".png\"\"";
-        system(command.c_str());
+
+        //render in process instead of spawning graphviz for every tree (see TreeRenderer.h)
+        std::ofstream svg;
+        svg.open(path.string() + ".svg");
+        svg << renderTreeSvg(tree, tree.name + suffix);
+        svg.close();
     }
 
     /*
@@ -358,6 +355,17 @@ namespace WowTalentTrees {
         }
     }
 
+    /*
+    Returns the representation string of the default tree that is used for the configuration counts (smaller tree in debug builds).
+    */
+    std::string getDefaultTreeString() {
+        return std::string(defaultTreeRep);
+    }
+
+    TalentTree getDefaultTree() {
+        return parseTree(getDefaultTreeString());
+    }
+
     void bloodmalletCount(int points) {
         std::vector<std::shared_ptr<bloodmallet::Talent>> talents;
         talents = bloodmallet::_create_talents();
@@ -381,19 +389,7 @@ namespace WowTalentTrees {
                 foo.end(),
                 [](auto&& item)
                 {
-#ifdef _DEBUG
-                    TalentTree tree = parseTree(
-                        "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1;B2.1:2-A1+C2;B3.1:1-A1+C3;C1.0:1-B1+E1,D1;C2.0:1-B2+;C3.0:1-B3+D2,E4,D3;D1.1:2-C1+E2;D2.1:2-C3+E2;D3.1:2-C3+;E1.1:3-C1+F1;E2.2:1_0-D1,D2+F2,F3;E4.1:1-C3+F4;"
-                        "F1.1:1-E1+G1,H1;F2.1:2-E2+G1;F3.1:2-E2+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H3;G3.1:1-F3,F4+H3;G4.1:2-F4+H4;H1.2:1_0-F1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G4+I4,I5;"
-                        "I1.1:1-H1+J1;I2.1:1-H1+;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3;I5.1:1-H4+J5;J1.2:1_0-I1+;J3.2:1_0-I3,I4+;J5.2:1_0-I5+;"
-                    );
-#else
-                    TalentTree tree = parseTree(
-                        "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1,D1;B2.1:2-A1+C2;B3.1:1-A1+C3,D2;C1.0:1-B1+E1,D1;C2.0:1-B2+D1,D2,E2;C3.0:1-B3+D2,E4,D3;D1.1:2-B1,C1,C2+E1,E2,F2;D2.1:2-B3,C2,C3+E2,F3,E4;D3.1:2-C3+E4;E1.1:3-C1,D1+F1,F2;E2.2:1_0-C2,D1,D2+F2,F3;E4.1:1-C3,D2,D3+F3,F4;"
-                        "F1.1:1-E1+G1,H1;F2.1:2-D1,E1,E2+G1;F3.1:2-D2,E2,E4+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H1,H3;G3.1:1-F3,F4+H3,H4;G4.1:2-F4+H4;H1.2:1_0-F1,G1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G3,G4+I4,I5;"
-                        "I1.1:1-H1+J1;I2.1:1-H1+J1,J3;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3,J5;I5.1:1-H4+J5;J1.2:1_0-I1,I2+;J3.2:1_0-I2,I3,I4+;J5.2:1_0-I4,I5+;"
-                    );
-#endif
+                    TalentTree tree = getDefaultTree();
                     tree.unspentTalentPoints = item;
 
                     auto t1 = std::chrono::high_resolution_clock::now();
@@ -407,19 +403,7 @@ namespace WowTalentTrees {
             if (points <= 0) {
                 //This snippet runs the configuration count for 1 to 42 available talent points.
                 for (int i = 1; i < 43; i++) {
-#ifdef _DEBUG
-                    TalentTree tree = parseTree(
-                        "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1;B2.1:2-A1+C2;B3.1:1-A1+C3;C1.0:1-B1+E1,D1;C2.0:1-B2+;C3.0:1-B3+D2,E4,D3;D1.1:2-C1+E2;D2.1:2-C3+E2;D3.1:2-C3+;E1.1:3-C1+F1;E2.2:1_0-D1,D2+F2,F3;E4.1:1-C3+F4;"
-                        "F1.1:1-E1+G1,H1;F2.1:2-E2+G1;F3.1:2-E2+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H3;G3.1:1-F3,F4+H3;G4.1:2-F4+H4;H1.2:1_0-F1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G4+I4,I5;"
-                        "I1.1:1-H1+J1;I2.1:1-H1+;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3;I5.1:1-H4+J5;J1.2:1_0-I1+;J3.2:1_0-I3,I4+;J5.2:1_0-I5+;"
-                    );
-#else
-                    TalentTree tree = parseTree(
-                        "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1,D1;B2.1:2-A1+C2;B3.1:1-A1+C3,D2;C1.0:1-B1+E1,D1;C2.0:1-B2+D1,D2,E2;C3.0:1-B3+D2,E4,D3;D1.1:2-B1,C1,C2+E1,E2,F2;D2.1:2-B3,C2,C3+E2,F3,E4;D3.1:2-C3+E4;E1.1:3-C1,D1+F1,F2;E2.2:1_0-C2,D1,D2+F2,F3;E4.1:1-C3,D2,D3+F3,F4;"
-                        "F1.1:1-E1+G1,H1;F2.1:2-D1,E1,E2+G1;F3.1:2-D2,E2,E4+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H1,H3;G3.1:1-F3,F4+H3,H4;G4.1:2-F4+H4;H1.2:1_0-F1,G1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G3,G4+I4,I5;"
-                        "I1.1:1-H1+J1;I2.1:1-H1+J1,J3;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3,J5;I5.1:1-H4+J5;J1.2:1_0-I1,I2+;J3.2:1_0-I2,I3,I4+;J5.2:1_0-I4,I5+;"
-                    );
-#endif
+                    TalentTree tree = getDefaultTree();
                     tree.unspentTalentPoints = i;
 
                     auto t1 = std::chrono::high_resolution_clock::now();
@@ -430,19 +414,7 @@ namespace WowTalentTrees {
                 }
             }
             else {
-#ifdef _DEBUG
-                TalentTree tree = parseTree(
-                    "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1;B2.1:2-A1+C2;B3.1:1-A1+C3;C1.0:1-B1+E1,D1;C2.0:1-B2+;C3.0:1-B3+D2,E4,D3;D1.1:2-C1+E2;D2.1:2-C3+E2;D3.1:2-C3+;E1.1:3-C1+F1;E2.2:1_0-D1,D2+F2,F3;E4.1:1-C3+F4;"
-                    "F1.1:1-E1+G1,H1;F2.1:2-E2+G1;F3.1:2-E2+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H3;G3.1:1-F3,F4+H3;G4.1:2-F4+H4;H1.2:1_0-F1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G4+I4,I5;"
-                    "I1.1:1-H1+J1;I2.1:1-H1+;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3;I5.1:1-H4+J5;J1.2:1_0-I1+;J3.2:1_0-I3,I4+;J5.2:1_0-I5+;"
-                );
-#else
-                TalentTree tree = parseTree(
-                    "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1,D1;B2.1:2-A1+C2;B3.1:1-A1+C3,D2;C1.0:1-B1+E1,D1;C2.0:1-B2+D1,D2,E2;C3.0:1-B3+D2,E4,D3;D1.1:2-B1,C1,C2+E1,E2,F2;D2.1:2-B3,C2,C3+E2,F3,E4;D3.1:2-C3+E4;E1.1:3-C1,D1+F1,F2;E2.2:1_0-C2,D1,D2+F2,F3;E4.1:1-C3,D2,D3+F3,F4;"
-                    "F1.1:1-E1+G1,H1;F2.1:2-D1,E1,E2+G1;F3.1:2-D2,E2,E4+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H1,H3;G3.1:1-F3,F4+H3,H4;G4.1:2-F4+H4;H1.2:1_0-F1,G1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G3,G4+I4,I5;"
-                    "I1.1:1-H1+J1;I2.1:1-H1+J1,J3;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3,J5;I5.1:1-H4+J5;J1.2:1_0-I1,I2+;J3.2:1_0-I2,I3,I4+;J5.2:1_0-I4,I5+;"
-                );
-#endif
+                TalentTree tree = getDefaultTree();
                 tree.unspentTalentPoints = points;
 
                 auto t1 = std::chrono::high_resolution_clock::now();
@@ -458,23 +430,11 @@ namespace WowTalentTrees {
 
         //this function should not be called without knowing what it does, purely for debugging/error checking purposes.
         //but the source code contains more useful function usages to expand/contract trees, converting uint64 indices of DAGs to a tree, etc.
-        //compareCombinations(fast_combinations, slow_combinations);
+        //compareCombinations(std::string(defaultTreeRep), fast_combinations, slow_combinations);
     }
 
     void parallelCombinationCount(int points) {
-#ifdef _DEBUG
-        TalentTree tree = parseTree(
-            "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1;B2.1:2-A1+C2;B3.1:1-A1+C3;C1.0:1-B1+E1,D1;C2.0:1-B2+;C3.0:1-B3+D2,E4,D3;D1.1:2-C1+E2;D2.1:2-C3+E2;D3.1:2-C3+;E1.1:3-C1+F1;E2.2:1_0-D1,D2+F2,F3;E4.1:1-C3+F4;"
-            "F1.1:1-E1+G1,H1;F2.1:2-E2+G1;F3.1:2-E2+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H3;G3.1:1-F3,F4+H3;G4.1:2-F4+H4;H1.2:1_0-F1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G4+I4,I5;"
-            "I1.1:1-H1+J1;I2.1:1-H1+;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3;I5.1:1-H4+J5;J1.2:1_0-I1+;J3.2:1_0-I3,I4+;J5.2:1_0-I5+;"
-        );
-#else
-        TalentTree tree = parseTree(
-            "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1,D1;B2.1:2-A1+C2;B3.1:1-A1+C3,D2;C1.0:1-B1+E1,D1;C2.0:1-B2+D1,D2,E2;C3.0:1-B3+D2,E4,D3;D1.1:2-B1,C1,C2+E1,E2,F2;D2.1:2-B3,C2,C3+E2,F3,E4;D3.1:2-C3+E4;E1.1:3-C1,D1+F1,F2;E2.2:1_0-C2,D1,D2+F2,F3;E4.1:1-C3,D2,D3+F3,F4;"
-            "F1.1:1-E1+G1,H1;F2.1:2-D1,E1,E2+G1;F3.1:2-D2,E2,E4+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H1,H3;G3.1:1-F3,F4+H3,H4;G4.1:2-F4+H4;H1.2:1_0-F1,G1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G3,G4+I4,I5;"
-            "I1.1:1-H1+J1;I2.1:1-H1+J1,J3;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3,J5;I5.1:1-H4+J5;J1.2:1_0-I1,I2+;J3.2:1_0-I2,I3,I4+;J5.2:1_0-I4,I5+;"
-        );
-#endif
+        TalentTree tree = getDefaultTree();
         tree.unspentTalentPoints = points;
 
         auto t1 = std::chrono::high_resolution_clock::now();
@@ -485,19 +445,7 @@ namespace WowTalentTrees {
     }
 
     void parallelCombinationCountThreaded(int points) {
-#ifdef _DEBUG
-        TalentTree tree = parseTree(
-            "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1;B2.1:2-A1+C2;B3.1:1-A1+C3;C1.0:1-B1+E1,D1;C2.0:1-B2+;C3.0:1-B3+D2,E4,D3;D1.1:2-C1+E2;D2.1:2-C3+E2;D3.1:2-C3+;E1.1:3-C1+F1;E2.2:1_0-D1,D2+F2,F3;E4.1:1-C3+F4;"
-            "F1.1:1-E1+G1,H1;F2.1:2-E2+G1;F3.1:2-E2+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H3;G3.1:1-F3,F4+H3;G4.1:2-F4+H4;H1.2:1_0-F1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G4+I4,I5;"
-            "I1.1:1-H1+J1;I2.1:1-H1+;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3;I5.1:1-H4+J5;J1.2:1_0-I1+;J3.2:1_0-I3,I4+;J5.2:1_0-I5+;"
-        );
-#else
-        TalentTree tree = parseTree(
-            "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1,D1;B2.1:2-A1+C2;B3.1:1-A1+C3,D2;C1.0:1-B1+E1,D1;C2.0:1-B2+D1,D2,E2;C3.0:1-B3+D2,E4,D3;D1.1:2-B1,C1,C2+E1,E2,F2;D2.1:2-B3,C2,C3+E2,F3,E4;D3.1:2-C3+E4;E1.1:3-C1,D1+F1,F2;E2.2:1_0-C2,D1,D2+F2,F3;E4.1:1-C3,D2,D3+F3,F4;"
-            "F1.1:1-E1+G1,H1;F2.1:2-D1,E1,E2+G1;F3.1:2-D2,E2,E4+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H1,H3;G3.1:1-F3,F4+H3,H4;G4.1:2-F4+H4;H1.2:1_0-F1,G1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G3,G4+I4,I5;"
-            "I1.1:1-H1+J1;I2.1:1-H1+J1,J3;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3,J5;I5.1:1-H4+J5;J1.2:1_0-I1,I2+;J3.2:1_0-I2,I3,I4+;J5.2:1_0-I4,I5+;"
-        );
-#endif
+        TalentTree tree = getDefaultTree();
         tree.unspentTalentPoints = points;
 
         auto t1 = std::chrono::high_resolution_clock::now();
@@ -520,11 +468,7 @@ namespace WowTalentTrees {
         std::cout << printTree(root) << std::endl;
         */
 
-        TalentTree tree = parseTree(
-            "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1;B2.1:2-A1+C2;B3.1:1-A1+C3;C1.0:1-B1+E1,D1;C2.0:1-B2+;C3.0:1-B3+D2,E4,D3;D1.1:2-C1+E2;D2.1:2-C3+E2;D3.1:2-C3+;E1.1:3-C1+F1;E2.2:1_0-D1,D2+F2,F3;E4.1:1-C3+F4;"
-            "F1.1:1-E1+G1,H1;F2.1:2-E2+G1;F3.1:2-E2+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H3;G3.1:1-F3,F4+H3;G4.1:2-F4+H4;H1.2:1_0-F1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G4+I4,I5;"
-            "I1.1:1-H1+J1;I2.1:1-H1+;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3;I5.1:1-H4+J5;J1.2:1_0-I1+;J3.2:1_0-I3,I4+;J5.2:1_0-I5+;"
-        );
+        TalentTree tree = getDefaultTree();
         printTree(tree);
 
         //visualizeTree(tree, "");
@@ -552,7 +496,7 @@ namespace WowTalentTrees {
         */
 
         std::unordered_set<std::string> slow_combinations;
-        //compareCombinations(fast_combinations, slow_combinations);
+        //compareCombinations(std::string(defaultTreeRep), fast_combinations, slow_combinations);
     }
 
 
@@ -590,11 +534,15 @@ namespace WowTalentTrees {
         for (auto& root : sortedTreeDAG.rootIndices) {
             possibleTalents.push_back(root);
         }
+        EnumerationTelemetry telemetry{ "visitTalent", talentPoints, {} };
         for (int i = 0; i < possibleTalents.size(); i++) {
             //only start with root nodes that have points required == 0, prevents from starting at root nodes that might come later in the tree (e.g. druid wild charge)
-            if (sortedTreeDAG.sortedTalents[possibleTalents[i]]->pointsRequired == 0)
+            if (sortedTreeDAG.sortedTalents[possibleTalents[i]]->pointsRequired == 0) {
+                StartPointTelemetryScope telemetryScope(telemetry, i, possibleTalents[i]);
                 visitTalent(possibleTalents[i], visitedTalents, i + 1, 1, 0, talentPointsLeft, possibleTalents, mDAG, ptsReq, combinations, allCombinations);
+            }
         }
+        writeTelemetryJson(telemetry);
         std::cout << "Number of configurations for " << talentPoints << " talent points without switch talents: " << combinations.size() << " and with : " << allCombinations << std::endl;
 
         free(mDAG);
@@ -626,12 +574,14 @@ namespace WowTalentTrees {
         if finished perform bit shift on uint64 to get unique tree index and put it in configuration set
         */
         //do combination housekeeping
+        WTT_TELEMETRY_COUNT(nodesVisited);
         setTalent(visitedTalents, talentIndex);
         talentPointsSpent += 1;
         talentPointsLeft -= 1;
         currentMultiplier *= getValueFromMDAGArray(mDAG, talentIndex, 0);
         //check if path is complete
         if (talentPointsLeft == 0) {
+            WTT_TELEMETRY_COUNT(emittedBuilds);
             combinations.push_back(std::pair<std::bitset<128>, int>(visitedTalents, currentMultiplier));
             allCombinations += currentMultiplier;
             return;
@@ -640,6 +590,7 @@ namespace WowTalentTrees {
         //sorting guarantees that these paths were visited earlier already)
         if (*mDAG - talentIndex - 1 < talentPointsLeft) {
             //cannot use up all the leftover talent points, therefore incomplete
+            WTT_TELEMETRY_COUNT(prunes);
             return;
         }
         //add all possible children to the set for iteration
@@ -653,6 +604,9 @@ namespace WowTalentTrees {
                 talentPointsSpent >= *(ptsReq+possibleTalents[i])) {
                 visitTalent(possibleTalents[i], visitedTalents, i + 1, currentMultiplier, talentPointsSpent, talentPointsLeft, possibleTalents, mDAG, ptsReq, combinations, allCombinations);
             }
+            else if (possibleTalents[i] > talentIndex) {
+                WTT_TELEMETRY_COUNT(gateRejections);
+            }
         }
     }
 
@@ -690,11 +644,15 @@ namespace WowTalentTrees {
             possibleTalents.push_back(root);
         }
 
+        EnumerationTelemetry telemetry{ "visitTalentParallel", talentPoints, {} };
         for (int i = 0; i < possibleTalents.size(); i++) {
             //only start with root nodes that have points required == 0, prevents from starting at root nodes that might come later in the tree (e.g. druid wild charge)
-            if (sortedTreeDAG.sortedTalents[possibleTalents[i]]->pointsRequired == 0) 
-                    visitTalentParallel(possibleTalents[i], visitedTalents, i + 1, 1, 0, talentPointsLeft, possibleTalents, sortedTreeDAG, combinations, allCombinations);
+            if (sortedTreeDAG.sortedTalents[possibleTalents[i]]->pointsRequired == 0) {
+                StartPointTelemetryScope telemetryScope(telemetry, i, possibleTalents[i]);
+                visitTalentParallel(possibleTalents[i], visitedTalents, i + 1, 1, 0, talentPointsLeft, possibleTalents, sortedTreeDAG, combinations, allCombinations);
+            }
         }
+        writeTelemetryJson(telemetry);
         for (int i = 0; i < talentPoints; i++) {
             std::cout << "Number of configurations for " << i + 1 << " talent points without switch talents: " << combinations[i].size() << " and with : " << allCombinations[i] << std::endl;
         }
@@ -724,11 +682,14 @@ namespace WowTalentTrees {
 
         int talentPointsLeft = tree.unspentTalentPoints;
         int threadCount = 100;
-        std::vector<StartPoint> startPoints = getStartPoints(sortedTreeDAG, talentPointsLeft, threadCount);
+        //combinations that are completed while splitting the tree into start points are stored directly in combinations/allCombinations
+        std::vector<StartPoint> startPoints = getStartPoints(sortedTreeDAG, talentPointsLeft, threadCount, combinations, allCombinations);
         std::vector< std::vector<std::vector<std::pair<std::bitset<128>, int>>>> threadCombinations;
-        threadCombinations.resize(startPoints.size(), combinations);
+        threadCombinations.resize(startPoints.size());
         std::vector<std::vector<int>> threadAllCombinations;
-        threadAllCombinations.resize(startPoints.size(), allCombinations);
+        threadAllCombinations.resize(startPoints.size());
+        EnumerationTelemetry telemetry{ "visitTalentParallelThreaded", talentPoints, {} };
+        telemetry.startPoints.resize(startPoints.size());
 
         //iterate through all possible combinations in order:
         //have 4 variables: visited nodes (int vector with capacity = # talent points), num talent points left, int vector of possible nodes to visit, weight of combination
@@ -741,11 +702,16 @@ namespace WowTalentTrees {
             tcombinations.resize(talentPoints);
             std::vector<int> tallCombinations;
             tallCombinations.resize(talentPoints, 0);
+            StartPointTelemetryScope telemetryScope(telemetry.startPoints[i], i, sp.talentIndex);
             visitTalentParallel(sp.talentIndex, sp.visitedTalents, sp.currentPosTalIndex, sp.currentMultiplier, sp.talentPointsSpent, sp.talentPointsLeft, sp.possibleTalents, sortedTreeDAG, tcombinations, tallCombinations);
             threadCombinations[i] = tcombinations;
             threadAllCombinations[i] = tallCombinations;
             std::cout << i << "D\n";
         }
+        writeTelemetryJson(telemetry);
+        //prefix combinations are treated as an additional thread result
+        threadCombinations.push_back(combinations);
+        threadAllCombinations.push_back(allCombinations);
 
         std::vector<std::pair<int, int>> result(talentPoints);
         for (int i = 0; i < talentPoints; i++) {
@@ -760,7 +726,18 @@ namespace WowTalentTrees {
         return threadCombinations;
     }
 
-    std::vector<StartPoint> getStartPoints(const TreeDAGInfo& sortedTreeDAG, int talentPointsLeft, int numThreads) {
+    /*
+    Splits the search space of visitTalentParallel into (at least) numThreads independent start points by expanding the search breadth first.
+    Every expanded start point is a complete combination itself, these are stored in prefixCombinations/prefixAllCombinations (indexed like
+    in visitTalentParallel) since they are not part of any returned start point. The result is deterministic for a given tree, budget and numThreads.
+    */
+    std::vector<StartPoint> getStartPoints(
+        const TreeDAGInfo& sortedTreeDAG,
+        int talentPointsLeft,
+        int numThreads,
+        std::vector<std::vector<std::pair<std::bitset<128>, int>>>& prefixCombinations,
+        std::vector<int>& prefixAllCombinations
+    ) {
         std::deque<StartPoint> spQ;
 
         std::vector<int> possibleTalents;
@@ -773,30 +750,43 @@ namespace WowTalentTrees {
             }
         }
 
-        while (spQ.size() < numThreads) {
+        //if the queue runs empty the whole tree got enumerated through the prefixes
+        while (spQ.size() > 0 && spQ.size() < numThreads) {
             StartPoint spQf = spQ.front();
             spQ.pop_front();
+            //do the same housekeeping as visitTalentParallel
             setTalent(spQf.visitedTalents, spQf.talentIndex);
+            spQf.talentPointsSpent += 1;
+            spQf.talentPointsLeft -= 1;
+            spQf.currentMultiplier *= sortedTreeDAG.minimalTreeDAG[spQf.talentIndex][0];
+            prefixCombinations[spQf.talentPointsSpent - 1].push_back(std::pair<std::bitset<128>, int>(spQf.visitedTalents, spQf.currentMultiplier));
+            prefixAllCombinations[spQf.talentPointsSpent - 1] += spQf.currentMultiplier;
+            if (spQf.talentPointsLeft == 0)
+                continue;
             //add all possible children to the set for iteration
             for (int i = 1; i < sortedTreeDAG.minimalTreeDAG[spQf.talentIndex].size(); i++) {
                 insert_into_vector(spQf.possibleTalents, sortedTreeDAG.minimalTreeDAG[spQf.talentIndex][i]);
             }
             for (int i = static_cast<int>(spQf.possibleTalents.size() - 1); i >= spQf.currentPosTalIndex; i--) {
+                //same order and points required checks as visitTalentParallel
+                if (spQf.possibleTalents[i] <= spQf.talentIndex ||
+                    spQf.talentPointsSpent < sortedTreeDAG.sortedTalents[spQf.possibleTalents[i]]->pointsRequired)
+                    continue;
                 StartPoint spC = {
                     spQf.possibleTalents[i],
                     spQf.visitedTalents,
                     i + 1,
-                    spQf.currentMultiplier * sortedTreeDAG.minimalTreeDAG[spQf.talentIndex][0],
-                    spQf.talentPointsSpent + 1,
-                    spQf.talentPointsLeft - 1,
+                    spQf.currentMultiplier,
+                    spQf.talentPointsSpent,
+                    spQf.talentPointsLeft,
                     spQf.possibleTalents
                 };
                 spQ.push_back(spC);
             }
         }
-        
+
         return {spQ.begin(), spQ.end()};
-    }    
+    }
 
     /*
     Parallel version of recursive talent visitation that does not early stop and keeps track of all paths shorter than max path length.
@@ -820,11 +810,13 @@ namespace WowTalentTrees {
         if finished perform bit shift on uint64 to get unique tree index and put it in configuration set
         */
         //do combination housekeeping
+        WTT_TELEMETRY_COUNT(nodesVisited);
         setTalent(visitedTalents, talentIndex);
         talentPointsSpent += 1;
         talentPointsLeft -= 1;
         currentMultiplier *= sortedTreeDAG.minimalTreeDAG[talentIndex][0];
 
+        WTT_TELEMETRY_COUNT(emittedBuilds);
         combinations[talentPointsSpent - 1].push_back(std::pair<std::bitset<128>, int>(visitedTalents, currentMultiplier));
         allCombinations[talentPointsSpent - 1] += currentMultiplier;
         if (talentPointsLeft == 0)
@@ -841,6 +833,9 @@ namespace WowTalentTrees {
                 talentPointsSpent >= sortedTreeDAG.sortedTalents[possibleTalents[i]]->pointsRequired) {
                 visitTalentParallel(possibleTalents[i], visitedTalents, i + 1, currentMultiplier, talentPointsSpent, talentPointsLeft, possibleTalents, sortedTreeDAG, combinations, allCombinations);
             }
+            else if (possibleTalents[i] > talentIndex) {
+                WTT_TELEMETRY_COUNT(gateRejections);
+            }
         }
     }
 
@@ -874,6 +869,7 @@ namespace WowTalentTrees {
                 t->points = 0;
                 t->maxPoints = 1;
                 t->talentSwitch = talent->talentSwitch;
+                t->choiceCount = talent->choiceCount;
                 t->parents.push_back(talentParts[i]);
                 talentParts.push_back(t);
                 talentParts[i]->children.push_back(t);
@@ -946,6 +942,7 @@ namespace WowTalentTrees {
             }
             t->maxPoints = static_cast<int>(talentParts.size());
             t->talentSwitch = talent->talentSwitch;
+            t->choiceCount = talent->choiceCount;
             t->parents = talentParts[0]->parents;
             t->children = talentParts[talentParts.size() - 1]->children;
 
@@ -1038,7 +1035,7 @@ namespace WowTalentTrees {
         //convert sorted talents to minimalTreeDAG representation (raw talents -> integer index vectors)
         for (auto& talent : info.sortedTalents) {
             std::vector<int> child_indices(talent->children.size() + 1);
-            child_indices[0] = talent->type == TalentType::SWITCH ? 2 : 1;
+            child_indices[0] = talent->type == TalentType::SWITCH ? talent->choiceCount : 1;
             for (int i = 0; i < talent->children.size(); i++) {
                 ptrdiff_t pos = std::distance(info.sortedTalents.begin(), std::find(info.sortedTalents.begin(), info.sortedTalents.end(), talent->children[i]));
                 if (pos >= static_cast<int>(info.sortedTalents.size())) {
@@ -1062,25 +1059,19 @@ namespace WowTalentTrees {
     /*
     Debug function to compare the combinations of the slow legacy method with the fast counting for error checking purposes.
     Creates two files that hold all combinations in the string representation after sorting to make file diff easy and quick.
+    Fast combinations are translated with the batch decoder (see BuildDecoder.h) instead of filling out a tree per combination. The decoder is created from
+    a freshly parsed tree of treeRep (the representation the fast combinations were counted from), counting expands the talents of the counted tree in place.
     */
-    void compareCombinations(const std::unordered_map<std::bitset<128>, int>& fastCombinations, const std::unordered_set<std::string>& slowCombinations, std::string suffix) {
+    void compareCombinations(const std::string& treeRep, const std::vector<std::pair<std::bitset<128>, int>>& fastCombinations, const std::unordered_set<std::string>& slowCombinations, std::string suffix) {
         std::string directory = "C:\\Users\\Tobi\\Documents\\Programming\\CodeSnippets\\WowTalentTrees\\TreesInputsOutputs";
 
-        std::vector<std::string> fastCombinationsOrdered;
-        int count = 0;
+        BuildDecoder decoder = createBuildDecoder(parseTree(treeRep));
+        std::vector<uint64_t> fastCombinationMasks;
+        fastCombinationMasks.reserve(fastCombinations.size());
         for (auto& comb : fastCombinations) {
-            if (count++ % 100 == 0)
-                std::cout << count << std::endl;
-            TalentTree tree = parseTree(
-                "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1;B2.1:2-A1+C2;B3.1:1-A1+C3;C1.0:1-B1+E1,D1;C2.0:1-B2+;C3.0:1-B3+D2,E4,D3;D1.1:2-C1+E2;D2.1:2-C3+E2;D3.1:2-C3+;E1.1:3-C1+F1;E2.2:1_0-D1,D2+F2,F3;E4.1:1-C3+F4;"
-                "F1.1:1-E1+G1,H1;F2.1:2-E2+G1;F3.1:2-E2+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H3;G3.1:1-F3,F4+H3;G4.1:2-F4+H4;H1.2:1_0-F1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G4+I4,I5;"
-                "I1.1:1-H1+J1;I2.1:1-H1+;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3;I5.1:1-H4+J5;J1.2:1_0-I1+;J3.2:1_0-I3,I4+;J5.2:1_0-I5+;"
-            );
-            expandTreeTalents(tree);
-            //creating a treeDAG destroys all parents in the tree, but should not be necessary anyway
-            TreeDAGInfo treeDAG = createSortedMinimalDAG(tree);
-            fastCombinationsOrdered.push_back(fillOutTreeWithBinaryIndexToString(comb.first, tree, treeDAG));
+            fastCombinationMasks.push_back(comb.first.to_ullong());
         }
+        std::vector<std::string> fastCombinationsOrdered = decodeBuilds(decoder, fastCombinationMasks);
         std::sort(fastCombinationsOrdered.begin(), fastCombinationsOrdered.end());
 
         std::ofstream output_file_fast(directory + "\\trees_comparison_" + suffix + "_fast.txt");
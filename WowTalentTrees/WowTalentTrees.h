@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <vector>
 #include <set>
 #include <unordered_set>
 #include <unordered_map>
@@ -8,6 +10,22 @@
 #include <bitset>
 
 namespace WowTalentTrees {
+    /*
+    Representation string of the default tree that is used for the configuration counts (smaller tree in debug builds). It is a constexpr literal so it can
+    also be parsed at compile time (see StaticTreeCounter.h).
+    */
+#ifdef _DEBUG
+    constexpr std::string_view defaultTreeRep =
+        "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1;B2.1:2-A1+C2;B3.1:1-A1+C3;C1.0:1-B1+E1,D1;C2.0:1-B2+;C3.0:1-B3+D2,E4,D3;D1.1:2-C1+E2;D2.1:2-C3+E2;D3.1:2-C3+;E1.1:3-C1+F1;E2.2:1_0-D1,D2+F2,F3;E4.1:1-C3+F4;"
+        "F1.1:1-E1+G1,H1;F2.1:2-E2+G1;F3.1:2-E2+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H3;G3.1:1-F3,F4+H3;G4.1:2-F4+H4;H1.2:1_0-F1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G4+I4,I5;"
+        "I1.1:1-H1+J1;I2.1:1-H1+;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3;I5.1:1-H4+J5;J1.2:1_0-I1+;J3.2:1_0-I3,I4+;J5.2:1_0-I5+;";
+#else
+    constexpr std::string_view defaultTreeRep =
+        "A1.0:1-+B1,B2,B3;B1.0:1-A1+C1,D1;B2.1:2-A1+C2;B3.1:1-A1+C3,D2;C1.0:1-B1+E1,D1;C2.0:1-B2+D1,D2,E2;C3.0:1-B3+D2,E4,D3;D1.1:2-B1,C1,C2+E1,E2,F2;D2.1:2-B3,C2,C3+E2,F3,E4;D3.1:2-C3+E4;E1.1:3-C1,D1+F1,F2;E2.2:1_0-C2,D1,D2+F2,F3;E4.1:1-C3,D2,D3+F3,F4;"
+        "F1.1:1-E1+G1,H1;F2.1:2-D1,E1,E2+G1;F3.1:2-D2,E2,E4+G3;F4.1:1-E4+G3,G4;G1.2:1_0-F1,F2+H1,H3;G3.1:1-F3,F4+H3,H4;G4.1:2-F4+H4;H1.2:1_0-F1,G1+I1,I2,I3;H3.1:1-G1,G3+I3,I4;H4.0:1-G3,G4+I4,I5;"
+        "I1.1:1-H1+J1;I2.1:1-H1+J1,J3;I3.1:2-H1,H3+J3;I4.1:2-H3,H4+J3,J5;I5.1:1-H4+J5;J1.2:1_0-I1,I2+;J3.2:1_0-I2,I3,I4+;J5.2:1_0-I4,I5+;";
+#endif
+
     struct StartPoint {
         int talentIndex;
         std::bitset<128> visitedTalents;
@@ -18,10 +36,55 @@ namespace WowTalentTrees {
         std::vector<int> possibleTalents;
     };
 
-    enum class TalentType;
-    struct TalentTree;
     struct Talent;
-    struct TreeDAGInfo;
+
+    // Switch talents can select/switch between 2 talents in the same slot
+    enum class TalentType {
+        ACTIVE, PASSIVE, SWITCH
+    };
+
+    /*
+    A tree has a name, (un)spent talent points and a list of root talents (talents without parents) that are the starting point
+    */
+    struct TalentTree {
+        std::string name = "defaultTree";
+        int unspentTalentPoints = 30;
+        int spentTalentPoints = 0;
+        std::vector<std::shared_ptr<Talent>> talentRoots;
+    };
+
+    /*
+    A talent has an index (scheme: https://github.com/Bloodmallet/simc_support/blob/feature/10-0-experiments/simc_support/game_data/full_tree_coordinates.jpg),
+    a name (currently not used), a type, the (max) points and a switch (might make the talent type redundant) as well as a list of all parents and children in
+    a simple graph structure.
+    */
+    struct Talent {
+        std::string index = "";
+        std::string name = "";
+        TalentType type = TalentType::ACTIVE;
+        int points = 0;
+        int maxPoints = 0;
+        int pointsRequired = 0;
+        int talentSwitch = -1;
+        //number of talents a switch talent selects from
+        int choiceCount = 2;
+        std::vector<std::shared_ptr<Talent>> parents;
+        std::vector<std::shared_ptr<Talent>> children;
+    };
+
+    /*
+    This is the container for the heavily optimized, topologically sorted DAG variant of the talent tree.
+    The regular talent tree has all the meta information and easy readable/debugable structures whereas this container
+    only has integer indices with an unconnected raw list of talents for computational efficieny.
+    NOTE: The talents aren't selected (i.e. Talent::points incremented) at all but a flag is set in a uint64 which is used
+    as an indexer. There exist routines that translate from uint64 to a regular tree and in the future maybe vice versa.
+    */
+    struct TreeDAGInfo {
+        std::vector<std::vector<int>> minimalTreeDAG;
+        std::vector<std::shared_ptr<Talent>> sortedTalents;
+        std::vector<int> rootIndices;
+    };
+
     void addChild(std::shared_ptr<Talent> parent, std::shared_ptr<Talent> child);
     void addParent(std::shared_ptr<Talent> child, std::shared_ptr<Talent> parent);
     void pairTalents(std::shared_ptr<Talent> parent, std::shared_ptr<Talent> child);
@@ -32,7 +95,7 @@ namespace WowTalentTrees {
     std::shared_ptr<Talent> createTalent(std::string name, int maxPoints);
     TalentTree parseTree(std::string treeRep);
     std::vector<std::string> splitString(std::string s, std::string delimiter);
-    void visualizeTree(TalentTree root, std::string suffix);
+    void visualizeTree(TalentTree root, std::string suffix, std::string directory = "TreesInputsOutputs");
     void visualizeTalentConnections(std::shared_ptr<Talent> root, std::stringstream& connections);
     std::string visualizeTalentInformation(TalentTree tree);
     void getTalentInfos(std::shared_ptr<Talent> talent, std::unordered_map<std::string, std::string>& talentInfos);
@@ -40,6 +103,8 @@ namespace WowTalentTrees {
     std::string getShape(TalentType type);
     std::string getSwitchLabel(int talentSwitch);
 
+    std::string getDefaultTreeString();
+    TalentTree getDefaultTree();
     void bloodmalletCount(int points);
     void individualCombinationCount(int points);
     void parallelCombinationCount(int points);
@@ -80,9 +145,15 @@ namespace WowTalentTrees {
         std::vector<int>& allCombinations
     );
     inline void setTalent(std::bitset<128>& talent, int index);
-    std::vector<StartPoint> getStartPoints(const TreeDAGInfo& sortedTreeDAG, int talentPointsLeft, int numThreads);
+    std::vector<StartPoint> getStartPoints(
+        const TreeDAGInfo& sortedTreeDAG,
+        int talentPointsLeft,
+        int numThreads,
+        std::vector<std::vector<std::pair<std::bitset<128>, int>>>& prefixCombinations,
+        std::vector<int>& prefixAllCombinations
+    );
 
-    void compareCombinations(const std::unordered_map<std::bitset<128>, int>& fastCombinations, const std::unordered_set<std::string>& slowCombinations, std::string suffix = "");
+    void compareCombinations(const std::string& treeRep, const std::vector<std::pair<std::bitset<128>, int>>& fastCombinations, const std::unordered_set<std::string>& slowCombinations, std::string suffix = "");
     std::string fillOutTreeWithBinaryIndexToString(std::bitset<128> comb, TalentTree tree, TreeDAGInfo treeDAG);
     void insert_into_vector(std::vector<int>& v, const int& t);
     int* convertMinimalTreeDAGToArray(TreeDAGInfo& DAG);